@@ -0,0 +1,26 @@
+#!/bin/sh
+# bench/run.sh - time every collector against each captured fixture tree.
+# Usage: bench/run.sh [binary] [runs]
+#
+# Each fixture under bench/fixtures/ is a trimmed capture of /proc, /sys and
+# /etc from one class of machine; --sysroot points the collectors at it, so
+# the numbers measure parsing, not whatever box the bench happens to run on.
+
+BIN=${1:-./xfetch}
+RUNS=${2:-20}
+
+# Only spawn_live() in src/common.c may create processes; everything else
+# has to go through uf_spawn_read so --allow-spawn can gate it.
+if grep -nE '\b(fork|vfork|popen|system|posix_spawnp?|execl|execvp?)[[:space:]]*\(' src/*.c | grep -v '^src/common\.c:'; then
+    echo "process creation outside src/common.c" >&2
+    exit 1
+fi
+
+# --bench itself fails if the kernel saw any collector create a child
+# process without --allow-spawn, however it was created.
+
+for fx in bench/fixtures/*/; do
+    echo "== $(basename "$fx")"
+    "$BIN" --sysroot "$fx" --bench "$RUNS" || exit 1
+    echo
+done
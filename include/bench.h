@@ -0,0 +1,16 @@
+// include/bench.h
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stddef.h>
+
+// Run each listed module `iterations` times on the calling thread, bypassing
+// the fact cache, and print the first (cold) run's wall time, min/median/p99
+// over the warm runs after it, CPU time and per-run I/O (opens, read
+// syscalls, bytes read, child processes) for each. Indexes shared between
+// modules (cpuinfo) may already be warm for a module's first run.
+// Returns the total number of child processes the modules created, as
+// counted by the kernel rather than by the spawn helper.
+unsigned long long uf_bench_run(const int* ids, size_t count, int iterations);
+
+#endif
@@ -0,0 +1,26 @@
+// include/cache.h
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stddef.h>
+
+// Persistent store for facts that only change across reboots, kept in
+// $XDG_CACHE_HOME/xfetch/facts. Every entry carries a validator string; an
+// entry is a hit only when the boot id and its validator still match.
+void uf_cache_load(void);
+int  uf_cache_get(const char* key, const char* validator, char* out, size_t n);
+void uf_cache_put(const char* key, const char* validator, const char* value);
+void uf_cache_save(void);
+
+// The cache directory, created (mode 0700) when `create` is set. Returns 0
+// if there is no usable location or the cache is disabled.
+int uf_cache_dir(char* out, size_t n, int create);
+
+// --no-cache: from here on uf_cache_dir finds nothing, so no cached file
+// (fact cache or pci.ids index) is read or written.
+void uf_cache_disable(void);
+
+// Append "path@inode:mtime" of a file to a validator (empty stamp if missing).
+void uf_cache_stamp_file(const char* path, char* out, size_t n);
+
+#endif
@@ -3,6 +3,11 @@
 
 #define _GNU_SOURCE
 #include <stddef.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+struct utsname;
+struct sysinfo;
 
 #define C0 "\x1b[0m"
 #define C1 "\x1b[36m"  // cyan
@@ -13,14 +18,102 @@
 #define C6 "\x1b[31m"  // red
 #define CX "\x1b[1m"   // bold
 
+#define UF_TIMEOUT_TEXT "N/A (timeout)"
+
 extern int UF_USE_ICONS;     // set via arg
 extern int UF_IS_ANDROID;    // set by detect_android()
+extern long long UF_DEADLINE_MS;   // global --timeout-ms budget (monotonic ms, 0 = none)
+extern int UF_ALLOW_SPAWN;   // --allow-spawn; otherwise no child process is ever created
 
 void uf_detect_android(void);
 
+// I/O layer. Every absolute path a collector opens goes through these, so a
+// captured tree (--sysroot / XFETCH_SYSROOT) or a snapshot archive
+// (--record / --replay, see record.h) can stand in for the running system.
+// The sysroot is set once, before any collection starts.
+void uf_sysroot_set(const char* dir);   // NULL or "" = the live system
+const char* uf_sysroot(void);           // "" when unset
+// `path` rewritten under the sysroot (buf is used only when needed);
+// NULL if it does not fit.
+const char* uf_path(const char* path, char* buf, size_t n);
+// Files are read with openat() + pread() straight into the caller's buffer;
+// the parent directory's fd is opened once and cached, so repeated reads
+// under /sys/devices/system/cpu, /sys/class/drm/cardN/device, ... do not
+// walk the full path again.
+// Up to n-1 bytes of the file, NUL terminated; -1 if it cannot be opened.
+ssize_t uf_read_file(const char* path, char* out, size_t n);
+// Same for `name` relative to `dir`; name may have several components
+// ("cpu3/topology/core_id"), only dir's fd is cached.
+ssize_t uf_read_file_at(const char* dir, const char* name, char* out, size_t n);
+// dir/name (just name when dir is NULL), trimmed; 1 if anything but
+// whitespace was read.
+int uf_read_value(const char* dir, const char* name, char* out, size_t n);
+// The whole file in a malloc'd, NUL-terminated buffer; NULL if missing.
+char* uf_read_file_alloc(const char* path, size_t* len);
+// A regular file mapped read-only until exit (not NUL terminated); NULL if
+// missing or empty. Under --replay this points into the archive itself.
+const char* uf_map_file(const char* path, size_t* len);
+// Release a uf_map_file mapping early (a no-op for archive-backed data).
+void uf_unmap_file(const void* data, size_t len);
+int uf_access(const char* path, int mode);
+// Symlink target, NUL terminated (truncated to n-1); -1 if path is not a link.
+ssize_t uf_readlink(const char* path, char* out, size_t n);
+
+typedef struct uf_dir uf_dir_t;
+uf_dir_t* uf_dir_open(const char* path);
+// Next entry name ("." and ".." skipped); *type gets the dirent d_type.
+const char* uf_dir_next(uf_dir_t* d, unsigned char* type);
+void uf_dir_close(uf_dir_t* d);
+
+int uf_uname(struct utsname* u);
+int uf_sysinfo(struct sysinfo* si);
+
+// Running totals for the calling thread (read by --bench).
+typedef struct {
+    unsigned long opens;    // files and directories opened through the I/O layer
+    unsigned long syscalls; // open/openat/pread/close issued by the file reader
+} uf_io_count_t;
+void uf_io_count(uf_io_count_t* out);
+
 void uf_trim(char* s);
+// First line of the file, trimmed; NULL if it is missing or empty.
 char* uf_read_first_line(const char* path, char* buf, size_t n);
 char* uf_exec_read(const char* cmd, char* buf, size_t n);
 void uf_human_bytes(unsigned long long bytes, char out[32]);
 
+// Streaming JSON writer over a caller-owned buffer. Strings are escaped
+// straight into it and nothing is allocated; output that does not fit is
+// cut off and `overflow` set. Keys are ignored (pass NULL) for array
+// elements and the top-level value.
+#define UF_JSON_DEPTH 16
+typedef struct uf_json {
+    char* buf;
+    size_t cap;
+    size_t len;
+    int depth;
+    int overflow;
+    unsigned char more[UF_JSON_DEPTH];   // this level already has a member
+    char close[UF_JSON_DEPTH];
+} uf_json_t;
+void uf_json_init(uf_json_t* j, char* buf, size_t cap);
+void uf_json_object(uf_json_t* j, const char* key);
+void uf_json_array(uf_json_t* j, const char* key);
+void uf_json_end(uf_json_t* j);   // closes the innermost object or array
+void uf_json_str(uf_json_t* j, const char* key, const char* s);   // null for NULL
+void uf_json_int(uf_json_t* j, const char* key, long long v);
+void uf_json_num(uf_json_t* j, const char* key, double v);   // null unless finite
+void uf_json_null(uf_json_t* j, const char* key);
+
+long long uf_now_ms(void);
+// Per-thread deadline for the module being collected (0 = only the global
+// budget). Resets the timeout flag.
+void uf_deadline_begin(int budget_ms);
+int uf_deadline_hit(void);   // a child process was killed since begin
+// Run `cmd` via /bin/sh, capturing up to n-1 bytes of stdout. The child gets
+// its own process group and is SIGKILLed when the deadline passes. Returns the
+// number of bytes captured, or -1 if the command could not run or timed out.
+// This is the only place the program creates processes; without
+// --allow-spawn it fails at once (a replay still serves recorded output).
+int uf_spawn_read(const char* cmd, char* buf, size_t n);
+
 #endif
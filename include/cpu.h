@@ -2,10 +2,14 @@
 #define CPU_H
 
 #include <stddef.h>
+#include "fact.h"
 
-void cpu_string(char* out, size_t n);
-void cpu_info_detailed(char* out, size_t n);
-void cpu_performance_info(char* out, size_t n);
+// name, vendor, core counts and base/max MHz: boot-stable, cached
+void cpu_fact(uf_fact_t* f);
+void cpu_text(const uf_fact_t* f, char* out, size_t n);
+// current/base/max MHz, temperature and governor, re-sampled
+void cpu_perf_fact(uf_fact_t* f);
+void cpu_perf_text(const uf_fact_t* f, char* out, size_t n);
 void cpu_soc_info(char* out, size_t n);
 
 #endif
@@ -0,0 +1,30 @@
+// include/cpuinfo.h
+#ifndef CPUINFO_H
+#define CPUINFO_H
+
+#include <stddef.h>
+
+// /proc/cpuinfo, read whole (any size) and indexed once per process; the
+// cpu and host modules share it instead of each rescanning the file.
+// Strings point into the index and stay valid until exit; NULL if absent.
+typedef struct {
+    int processor;                 // "processor" number, -1 outside a block
+    const char* model_name;        // "model name", "Model Name", "cpu model", "cpu"
+    const char* vendor;            // "vendor_id", "vendor"
+    double mhz;                    // "cpu MHz", "CPU MHz", "clock"; 0 if absent
+    const char* flags;             // "flags", "Features"
+    const char* cpu_part;          // arm "CPU part"
+    const char* cpu_implementer;   // arm "CPU implementer"
+} uf_cpuinfo_proc_t;
+
+typedef struct {
+    size_t count;
+    const uf_cpuinfo_proc_t* procs;   // one per processor block, in file order
+    uf_cpuinfo_proc_t common;         // lines outside any processor block
+    const char* hardware;             // arm "Hardware"
+} uf_cpuinfo_t;
+
+// NULL if /proc/cpuinfo cannot be read.
+const uf_cpuinfo_t* uf_cpuinfo(void);
+
+#endif
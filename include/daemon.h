@@ -0,0 +1,23 @@
+// include/daemon.h
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include <stddef.h>
+#include "module.h"
+
+#define UF_SNAPSHOT_MAX (UF_MOD_COUNT * (UF_FACT_TEXT_MAX + 32))
+
+// $XDG_RUNTIME_DIR/xfetch.sock, or /tmp/xfetch-<uid>/xfetch.sock in a 0700
+// directory we own (empty if that directory belongs to someone else)
+void uf_daemon_socket_path(char* out, size_t n);
+
+// Collect every module but the UF_MOD_ENV ones (clients collect those
+// themselves), re-sample the volatile ones every interval_ms and serve the
+// latest snapshot to each client that connects. Returns only on
+// SIGINT/SIGTERM (0) or setup failure (-1).
+int uf_daemon_run(const char* path, int interval_ms, int jobs, int use_cache);
+
+// Fetch the daemon's snapshot into `reg`. Returns 0 if no daemon answered.
+int uf_client_fetch(const char* path, uf_registry_t* reg);
+
+#endif
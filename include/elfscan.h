@@ -0,0 +1,14 @@
+// include/elfscan.h
+#ifndef ELFSCAN_H
+#define ELFSCAN_H
+
+#include <stddef.h>
+
+// Look for `needle` immediately followed by a digit in the read-only data of
+// the ELF executable at `path` (.rodata, or the read-only PT_LOAD segments
+// when the section table is stripped) and copy the version that follows it:
+// digits and dots, without a trailing dot. The file is mapped, not read.
+// Returns 1 if a version was found.
+int uf_elf_version(const char* path, const char* needle, char* out, size_t n);
+
+#endif
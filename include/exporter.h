@@ -0,0 +1,20 @@
+// include/exporter.h
+#ifndef EXPORTER_H
+#define EXPORTER_H
+
+// Prometheus text exposition of the collected facts: RAM, swap, CPU
+// temperature/frequency and uptime as gauges, OS/host/CPU/GPU as info
+// metrics. Boot-stable modules are collected once at start (the only time a
+// probe may spawn, with --allow-spawn); the volatile ones are re-sampled when
+// a scrape finds the last sample older than min_interval_ms.
+
+// Serve GET /metrics on "host:port" ("[v6addr]:port", ":port" for all
+// interfaces) until SIGINT/SIGTERM. Returns 0, or -1 on setup failure.
+int uf_exporter_serve(const char* listen, int min_interval_ms, int jobs, int use_cache);
+
+// Write the metrics to `path` for node_exporter's textfile collector
+// (atomically, through path.tmp). With interval_ms > 0 keep rewriting it
+// until SIGINT/SIGTERM; otherwise write once.
+int uf_exporter_textfile(const char* path, int interval_ms, int jobs, int use_cache);
+
+#endif
@@ -0,0 +1,68 @@
+// include/fact.h
+#ifndef FACT_H
+#define FACT_H
+
+#include <stddef.h>
+
+// What a module collected, as typed fields rather than a display string:
+// byte sizes and counts stay integers, clocks and temperatures stay floats,
+// names are copied once into the record's own string pool. Each output
+// backend formats straight from these, and only what it actually shows.
+typedef enum {
+    UF_FACT_NONE,      // not detected
+    UF_FACT_STR,
+    UF_FACT_INT,       // a count
+    UF_FACT_BYTES,
+    UF_FACT_SECONDS,
+    UF_FACT_MHZ,
+    UF_FACT_CELSIUS,
+    UF_FACT_PERCENT
+} uf_fact_type_t;
+
+#define UF_FACT_FIELDS 8
+#define UF_FACT_KEY 20
+#define UF_FACT_POOL 320
+// Longest uf_fact_encode() output, NUL included.
+#define UF_FACT_TEXT_MAX (UF_FACT_POOL + UF_FACT_FIELDS * (UF_FACT_KEY + 32))
+
+typedef struct {
+    char key[UF_FACT_KEY];
+    unsigned char type;
+    union {
+        long long i;       // INT, BYTES, SECONDS
+        double d;          // MHZ, CELSIUS, PERCENT
+        unsigned short s;  // STR: offset into the pool
+    } v;
+} uf_field_t;
+
+typedef struct {
+    unsigned char count;
+    unsigned short pool_len;
+    uf_field_t field[UF_FACT_FIELDS];
+    char pool[UF_FACT_POOL];
+} uf_fact_t;
+
+void uf_fact_init(uf_fact_t* f);
+// Setters append a field; a NULL or empty string is stored as NONE. Control
+// characters in strings become spaces, so the encoded form stays one line.
+void uf_fact_str(uf_fact_t* f, const char* key, const char* s);
+void uf_fact_int(uf_fact_t* f, const char* key, uf_fact_type_t type, long long v);
+void uf_fact_num(uf_fact_t* f, const char* key, uf_fact_type_t type, double v);
+void uf_fact_none(uf_fact_t* f, const char* key);
+// Replace a numeric field in place (appending it if missing).
+void uf_fact_set_num(uf_fact_t* f, const char* key, uf_fact_type_t type, double v);
+
+// The field, or NULL if it is missing or NONE.
+const uf_field_t* uf_fact_get(const uf_fact_t* f, const char* key);
+const char* uf_fact_field_str(const uf_fact_t* f, const uf_field_t* fld);
+// Shorthands returning `def` for a missing field.
+const char* uf_fact_get_str(const uf_fact_t* f, const char* key);   // NULL
+long long uf_fact_get_int(const uf_fact_t* f, const char* key, long long def);
+double uf_fact_get_num(const uf_fact_t* f, const char* key, double def);
+
+// One line, no tabs: "key=<type><value>" joined by \x1f. Used by the fact
+// cache and the daemon snapshot.
+size_t uf_fact_encode(const uf_fact_t* f, char* out, size_t n);
+int uf_fact_decode(uf_fact_t* f, const char* s, size_t len);   // fields read
+
+#endif
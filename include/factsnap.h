@@ -0,0 +1,45 @@
+// include/factsnap.h
+#ifndef FACTSNAP_H
+#define FACTSNAP_H
+
+#include <stddef.h>
+#include "module.h"
+#include "frame.h"
+
+// --save-snapshot / --diff-snapshot: every collected fact in one flat file
+// that is mapped and compared in place, with no text to parse.
+//
+// Layout (native endian, offsets from the start of the file):
+//   header  "XFFACT\0\0", u32 version, u32 count, u32 pool_off, u32 pool_len
+//   fields  count x { u32 module_off, u32 key_off, u32 type, u32 str_len,
+//                     i64 (INT, BYTES, SECONDS) | f64 (MHZ, CELSIUS, PERCENT)
+//                     | u64 str_off (STR) }
+//           sorted by (module, key) so two snapshots diff in one merge pass
+//   pool    module keys, field keys and string values, NUL terminated
+//
+// Module and field names are stored as strings, not ids, so a snapshot
+// stays comparable when modules are added.
+
+#define UF_FACTSNAP_VERSION 1
+
+typedef struct {
+    unsigned char* base;
+    size_t len;
+    int mapped;   // base came from mmap rather than malloc
+} uf_factsnap_t;
+
+// Image of everything collected in reg; 0 on success.
+int uf_factsnap_build(uf_factsnap_t* s, const uf_registry_t* reg);
+int uf_factsnap_save(const uf_factsnap_t* s, const char* path);
+// Map a snapshot file and bounds-check it once; -1 with errno set if it is
+// unreadable, truncated or of another version.
+int uf_factsnap_open(uf_factsnap_t* s, const char* path);
+void uf_factsnap_close(uf_factsnap_t* s);
+
+// "module.field: old -> new" into out for every field that differs between
+// a and b, in the modules flagged in select[] (by module id). Returns the
+// number of differences.
+int uf_factsnap_diff(const uf_factsnap_t* a, const uf_factsnap_t* b,
+                     const unsigned char* select, uf_frame_t* out);
+
+#endif
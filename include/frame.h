@@ -0,0 +1,44 @@
+// include/frame.h
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stddef.h>
+
+#define UF_FRAME_MAX (64 * 1024)
+
+// One screenful of output built in a preallocated buffer and handed to the
+// kernel in a single write(2), instead of a stdio call (and, on a pipe, a
+// flush) per line. A frame bound to fd -1 is a scratch buffer that only
+// collects text; one bound to a real fd writes early if it ever fills up.
+typedef struct {
+    char buf[UF_FRAME_MAX];
+    size_t len;
+    int fd;
+} uf_frame_t;
+
+void uf_frame_init(uf_frame_t* f, int fd);
+void uf_frame_put(uf_frame_t* f, const char* s, size_t n);
+void uf_frame_puts(uf_frame_t* f, const char* s);
+void uf_frame_printf(uf_frame_t* f, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+void uf_frame_pad(uf_frame_t* f, int cols);
+// Write out and empty the frame; returns 0 on success.
+int uf_frame_flush(uf_frame_t* f);
+
+// Terminal columns taken by n bytes of UTF-8 text. ANSI escape sequences
+// take none, nor do combining marks or variation selectors; East Asian wide
+// characters and emoji (including a narrow symbol followed by U+FE0F) take two.
+int uf_text_width(const char* s, size_t n);
+
+// Where compose put things, for redrawing single info lines later.
+typedef struct {
+    int info_top;    // frame row of the first info line
+    int info_col;    // 1-based terminal column the info lines start at
+    int rows;        // rows in the frame
+} uf_layout_t;
+
+// The logo, one rainbow colour per row, followed by the '\n' separated info
+// lines: stacked below the logo, or beside it when side_by_side is set.
+void uf_frame_compose(uf_frame_t* f, const char* art, const char* info, size_t info_len,
+                      int side_by_side, uf_layout_t* layout);
+
+#endif
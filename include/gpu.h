@@ -2,7 +2,13 @@
 #define GPU_H
 
 #include <stddef.h>
+#include "fact.h"
 
-void gpu_string(char* out, size_t n);
+// name, vendor, driver, memory and temperature of the first GPU; every key
+// is always present, NONE when undetected
+void gpu_fact(uf_fact_t* f);
+void gpu_text(const uf_fact_t* f, char* out, size_t n);
+void gpu_refresh(uf_fact_t* f);
+void gpu_cache_stamp(char* out, size_t n);
 
 #endif // GPU_H
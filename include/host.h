@@ -1,5 +1,7 @@
 // include/host.h
 #ifndef HOST_H
 #define HOST_H
-void host_string(char* out, size_t n);
+#include "fact.h"
+void host_fact(uf_fact_t* f);   // name, DMI family, vendor and SKU
+void host_text(const uf_fact_t* f, char* out, size_t n);
 #endif
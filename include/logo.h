@@ -0,0 +1,22 @@
+// include/logo.h
+#ifndef LOGO_H
+#define LOGO_H
+
+#include <stddef.h>
+
+// Logos compiled in from logos/*.txt by tools/logogen, sorted by name.
+typedef struct {
+    const char* name;   // file name, lower-cased, without ".txt"
+    const char* art;
+} uf_logo_t;
+
+extern const uf_logo_t uf_logos[];
+extern const size_t uf_logos_count;
+
+// Logo for the running system: the os-release ID, then each ID_LIKE entry,
+// then "android" on Android, then the xfetch logo. For every candidate
+// <override_dir>/<name>.txt (if a directory is given) is tried before the
+// embedded art. The text stays valid until exit.
+const char* uf_logo_resolve(const char* override_dir);
+
+#endif
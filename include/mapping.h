@@ -0,0 +1,38 @@
+// include/mapping.h
+#ifndef MAPPING_H
+#define MAPPING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Lookup tables compiled from mapping/*.txt by tools/mapgen at build time.
+// Rows are sorted by key; adding an entry is a data change only.
+typedef struct {
+    const char* key;
+    const char* value;
+} uf_map_str_t;
+
+typedef struct {
+    uint32_t key;
+    const char* value;
+} uf_map_num_t;
+
+extern const uf_map_str_t uf_map_soc[];         // mapping/soc.txt
+extern const size_t uf_map_soc_count;
+extern const uf_map_num_t uf_map_arm_parts[];   // mapping/arm-parts.txt
+extern const size_t uf_map_arm_parts_count;
+extern const uf_map_num_t uf_map_intel_gpu[];   // mapping/intel-gpu.txt
+extern const size_t uf_map_intel_gpu_count;
+extern const uf_map_num_t uf_map_macos[];       // mapping/macOs.txt
+extern const size_t uf_map_macos_count;
+
+// Binary search; NULL if the key has no row.
+const char* uf_map_find_str(const uf_map_str_t* map, size_t count, const char* key);
+const char* uf_map_find_num(const uf_map_num_t* map, size_t count, uint32_t key);
+
+// SoC marketing name for a hardware id ("SM8350", "MT6893V/CD", "Exynos 2100").
+const char* uf_map_soc_name(const char* hardware_id);
+// Core name for a MIDR implementer/part pair (0x41, 0xd05 -> "Cortex-A55").
+const char* uf_map_arm_part(unsigned implementer, unsigned part);
+
+#endif
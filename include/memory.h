@@ -1,5 +1,7 @@
 // include/memory.h
 #ifndef MEMORY_H
 #define MEMORY_H
-void memory_summary(char* out, size_t n); // "total, avail, usage%"
+#include "fact.h"
+void memory_fact(uf_fact_t* f);   // total, available, used_percent
+void memory_text(const uf_fact_t* f, char* out, size_t n); // "total, avail, usage%"
 #endif
@@ -0,0 +1,93 @@
+// include/module.h
+#ifndef MODULE_H
+#define MODULE_H
+
+#include <stddef.h>
+#include "fact.h"
+
+typedef enum {
+    UF_MOD_OS,
+    UF_MOD_HOST,
+    UF_MOD_KERNEL,
+    UF_MOD_ARCH,
+    UF_MOD_SHELL,
+    UF_MOD_TERMINAL,
+    UF_MOD_FONT,
+    UF_MOD_UPTIME,
+    UF_MOD_CPU,
+    UF_MOD_PERF,
+    UF_MOD_GPU,
+    UF_MOD_RAM,
+    UF_MOD_MEMORY,
+    UF_MOD_SWAP,
+    UF_MOD_COUNT
+} uf_module_id_t;
+
+typedef enum {
+    UF_COST_CHEAP,   // syscalls and environment only
+    UF_COST_FILE,    // reads procfs, sysfs or config files
+    UF_COST_SPAWN    // may fork external tools
+} uf_cost_t;
+
+#define UF_MOD_DETAIL 0x1   // hidden by --show-less
+#define UF_MOD_CACHED 0x2   // boot-stable, kept in the fact cache
+#define UF_MOD_VOLATILE 0x4 // changes while running, re-sampled by --watch and the daemon
+#define UF_MOD_WATCH  0x8   // shown by default only in --watch
+#define UF_MOD_ENV    0x10  // depends on the caller's environment; never served by the daemon
+
+#define UF_VALUE_MAX 256
+
+typedef struct {
+    const char* key;
+    const char* label;
+    const char* icon;
+    void (*collect)(char* out, size_t n);   // display string only; NULL when `fact` is set
+    uf_cost_t cost;
+    unsigned flags;
+    void (*stamp)(char* out, size_t n);   // extra cache validator, may be NULL
+    int deadline_ms;                      // budget for spawned probes, 0 = global only
+    void (*fact)(uf_fact_t* f);           // typed fields instead of a string
+    void (*text)(const uf_fact_t* f, char* out, size_t n);   // `fact` as one display line
+    void (*refresh)(uf_fact_t* f);        // re-read the fields that move, after a cache hit
+} uf_module_t;
+
+typedef struct {
+    uf_fact_t fact[UF_MOD_COUNT];
+    char value[UF_MOD_COUNT][UF_VALUE_MAX];   // text rendering, made on first use
+    unsigned char ready[UF_MOD_COUNT];
+    unsigned char shown[UF_MOD_COUNT];        // value[] matches fact[]
+    unsigned char missed[UF_MOD_COUNT];
+    char stamp[UF_MOD_COUNT][UF_VALUE_MAX];
+    int use_cache;
+} uf_registry_t;
+
+extern const uf_module_t uf_modules[UF_MOD_COUNT];
+
+int uf_module_find(const char* key);   // -1 if the key is unknown
+// 1 if facts of module `id` carry field `key`. Every module has "value",
+// its display line; string-only modules have nothing else.
+int uf_module_has_field(int id, const char* key);
+// Run one collector. String-only modules (and timed-out ones) leave a
+// single "value" field.
+void uf_module_collect(int id, uf_fact_t* f);
+// The display line for a fact of module `id`.
+void uf_module_text(int id, const uf_fact_t* f, char* out, size_t n);
+
+void uf_registry_init(uf_registry_t* reg, int use_cache);
+// Collect the listed modules (cache first, then up to `jobs` threads).
+void uf_registry_collect(uf_registry_t* reg, const int* ids, size_t count, int jobs);
+// Fields of one module, collecting it on first use.
+const uf_fact_t* uf_registry_fact(uf_registry_t* reg, int id);
+// Display line of one module, formatted from its fields on first use.
+const char* uf_registry_value(uf_registry_t* reg, int id);
+// Persist freshly collected boot-stable facts.
+void uf_registry_finish(uf_registry_t* reg);
+// Forget every volatile module so the next collect re-samples it.
+void uf_registry_invalidate_volatile(uf_registry_t* reg);
+
+// Snapshot of the collected facts as "key\t<uf_fact_encode>\n" lines.
+size_t uf_registry_dump(const uf_registry_t* reg, char* out, size_t n);
+// Fill the registry from a dump; returns the number of modules loaded.
+int uf_registry_load(uf_registry_t* reg, const char* snapshot);
+
+#endif
@@ -2,4 +2,6 @@
 #ifndef OS_H
 #define OS_H
 void os_string(char* out, size_t n);
+void kernel_string(char* out, size_t n);
+void arch_string(char* out, size_t n);
 #endif
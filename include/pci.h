@@ -0,0 +1,25 @@
+// include/pci.h
+#ifndef PCI_H
+#define PCI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// One PCI function as sysfs describes it under /sys/bus/pci/devices.
+typedef struct {
+    char slot[16];               // "0000:01:00.0"
+    uint16_t vendor;
+    uint16_t device;
+    uint16_t subsystem_vendor;
+    uint16_t subsystem_device;
+    char driver[32];             // bound driver ("" if none)
+    int boot_vga;                // the device the firmware initialised
+} uf_pci_dev_t;
+
+#define UF_PCI_CLASS_DISPLAY 0x03
+
+// Display-class functions (VGA, XGA, 3D, other display), in directory order.
+// One pass over the bus; returns how many were stored in out.
+size_t uf_pci_display(uf_pci_dev_t* out, size_t max);
+
+#endif
@@ -0,0 +1,17 @@
+// include/pciids.h
+#ifndef PCIIDS_H
+#define PCIIDS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Names from the hwdata pci.ids database. The text file is parsed once into
+// a sorted binary index kept in the cache directory (rebuilt when pci.ids
+// changes) and looked up by binary search over a mapping of it. Each returns
+// 1 and copies the name if the database has an entry.
+int uf_pciids_vendor(uint16_t vendor, char* out, size_t n);
+int uf_pciids_device(uint16_t vendor, uint16_t device, char* out, size_t n);
+int uf_pciids_subsystem(uint16_t vendor, uint16_t device,
+                        uint16_t subvendor, uint16_t subdevice, char* out, size_t n);
+
+#endif
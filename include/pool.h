@@ -0,0 +1,22 @@
+// include/pool.h
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+
+typedef struct {
+    const char* name;   // trace span label
+    void (*fn)(void* arg);
+    void* arg;
+    int deadline_ms;   // per-task budget for child processes, 0 = global only
+    int timed_out;     // set when a child process overran the deadline
+} uf_task_t;
+
+#define UF_POOL_MAX_WORKERS 16
+
+// Run every task once using up to `workers` threads and return after all of
+// them finished. workers <= 1 runs the tasks in order on the calling thread.
+// A task whose child process overran its deadline comes back timed_out.
+void uf_pool_run(uf_task_t* tasks, size_t count, int workers);
+
+#endif
@@ -0,0 +1,19 @@
+// include/props.h
+#ifndef PROPS_H
+#define PROPS_H
+
+#include <stddef.h>
+
+// Android system properties without forking getprop. Bionic builds ask
+// __system_property_get first; everything else (and anything it does not
+// know) comes from the build.prop files, mapped and hashed once:
+//   /system/build.prop, /vendor/build.prop, /odm/etc/build.prop
+// The first definition of a key wins, as with init's read-only properties.
+// The files go through the I/O layer, so --sysroot fixtures work on Linux.
+
+#define UF_PROP_VALUE_MAX 92   // PROP_VALUE_MAX on Android
+
+// 1 with the value in out if the property is set and non-empty.
+int uf_prop_get(const char* key, char* out, size_t n);
+
+#endif
@@ -1,5 +1,7 @@
 // include/ram.h
 #ifndef RAM_H
 #define RAM_H
-void ram_string(char* out, size_t n); // "used / total"
+#include "fact.h"
+void ram_fact(uf_fact_t* f);   // total, used, available, cached, buffers
+void ram_text(const uf_fact_t* f, char* out, size_t n); // "used / total"
 #endif
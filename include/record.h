@@ -0,0 +1,44 @@
+// include/record.h
+#ifndef RECORD_H
+#define RECORD_H
+
+#include <stddef.h>
+
+// --record / --replay: every file, directory listing, command output and
+// system call result the collectors see, kept in one .xfsnap archive.
+//
+// Layout (native endian, offsets from the start of the file):
+//   header   "XFSNAP1\0", u32 entry_count, u32 reserved, u64 string_off, u64 blob_off
+//   entries  entry_count x { u32 kind, u32 flags, u32 key_off, u32 key_len,
+//                            u64 data_off, u64 data_len }
+//            sorted by (kind, key) so replay can bsearch the mapping in place
+//   strings  keys, NUL terminated
+//   blobs    contents back to back; a directory listing is a run of
+//            "<d_type byte><name>\0" records
+
+typedef enum {
+    UF_SNAP_FILE = 1,   // file contents
+    UF_SNAP_DIR,        // directory listing
+    UF_SNAP_EXIST,      // access() result
+    UF_SNAP_CMD,        // command stdout
+    UF_SNAP_CALL,       // raw uname() / sysinfo() result
+    UF_SNAP_LINK        // symlink target
+} uf_snap_kind_t;
+
+#define UF_SNAP_MISSING 0x1   // path absent, command failed or timed out
+
+enum { UF_SNAP_OFF, UF_SNAP_RECORD, UF_SNAP_REPLAY };
+
+extern int UF_SNAP_MODE;
+
+int uf_snap_record(const char* path);   // start capturing; written by uf_snap_finish
+int uf_snap_replay(const char* path);   // map an archive; -1 if it is unusable
+int uf_snap_finish(void);               // write the archive when recording
+
+// Remember one observation (the first one per kind+key wins). Returns the
+// stored copy of data, which stays valid until exit.
+const char* uf_snap_put(int kind, const char* key, const void* data, size_t len, int missing);
+// Replay lookup: 1 with *data/*len set, 0 if absent or recorded as missing.
+int uf_snap_get(int kind, const char* key, const char** data, size_t* len);
+
+#endif
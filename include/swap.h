@@ -1,5 +1,7 @@
 // include/swap.h
 #ifndef SWAP_H
 #define SWAP_H
-void swap_string(char* out, size_t n); // "used / total"
+#include "fact.h"
+void swap_fact(uf_fact_t* f);   // total, used
+void swap_text(const uf_fact_t* f, char* out, size_t n); // "used / total"
 #endif
@@ -0,0 +1,48 @@
+// include/template.h
+#ifndef TEMPLATE_H
+#define TEMPLATE_H
+
+#include <stddef.h>
+#include "module.h"
+#include "frame.h"
+
+// Single-line output templates for prompts and status bars:
+//
+//   {cpu}                the module's display line
+//   {ram.used}           one field, formatted for its type (bytes, GHz, °C, ...)
+//   {cpu.name:-24.16}    [-]width.precision: pad (left-aligned with '-') to a
+//                        display width; cut strings / set decimals to precision
+//   {#cyan} ... {#reset} colours (dropped with --color 0)
+//   {{ and }}            literal braces
+//
+// A template is compiled once into a flat op list over a private copy of the
+// source; rendering walks that list without allocating. An unknown module,
+// field or colour is a compile error, like a syntax error.
+
+#define UF_TPL_MAX 512
+#define UF_TPL_OPS 64
+
+typedef struct {
+    unsigned char op;
+    unsigned char module;
+    unsigned char left;       // '-' flag
+    unsigned char color;      // palette index for colour ops
+    short width;              // 0 = no padding
+    short precision;          // -1 = type default
+    unsigned short off, len;  // literal span, or the field key, in src
+} uf_tpl_op_t;
+
+typedef struct {
+    char src[UF_TPL_MAX];
+    uf_tpl_op_t op[UF_TPL_OPS];
+    int count;
+    int ids[UF_MOD_COUNT];    // referenced modules, first use first
+    size_t id_count;
+} uf_template_t;
+
+// 0 on success; otherwise -1 with a message in err.
+int uf_template_compile(uf_template_t* t, const char* fmt, char* err, size_t errn);
+// One line (newline included) into f; only the referenced modules are asked for.
+void uf_template_render(const uf_template_t* t, uf_registry_t* reg, int color, uf_frame_t* f);
+
+#endif
@@ -3,4 +3,6 @@
 #define TERMINALSHELL_H
 void shell_string(char* out, size_t n);
 void terminal_string(char* out, size_t n);
+void shell_cache_stamp(char* out, size_t n);
+void terminal_cache_stamp(char* out, size_t n);
 #endif
@@ -0,0 +1,33 @@
+// include/trace.h
+#ifndef TRACE_H
+#define TRACE_H
+
+// --trace FILE: Trace Event Format JSON (chrome://tracing, ui.perfetto.dev)
+// with one complete ("X") event per span. Spans nest per thread and must be
+// closed on the thread that opened them.
+//
+// Built with -DUF_TRACE (Makefile TRACE=1, the default). Without it the
+// hooks below expand to nothing.
+
+#ifdef UF_TRACE
+
+extern int UF_TRACE_ON;
+
+int uf_trace_open(const char* path);    // start collecting events
+void uf_trace_begin(const char* name, const char* detail);   // name must be static
+void uf_trace_end(void);
+int uf_trace_finish(void);              // write the file
+
+#define UF_TRACE_BEGIN(name)            do { if (UF_TRACE_ON) uf_trace_begin((name), NULL); } while (0)
+#define UF_TRACE_BEGIN_ARG(name, detail) do { if (UF_TRACE_ON) uf_trace_begin((name), (detail)); } while (0)
+#define UF_TRACE_END()                  do { if (UF_TRACE_ON) uf_trace_end(); } while (0)
+
+#else
+
+#define UF_TRACE_BEGIN(name)            ((void)0)
+#define UF_TRACE_BEGIN_ARG(name, detail) ((void)0)
+#define UF_TRACE_END()                  ((void)0)
+
+#endif
+
+#endif
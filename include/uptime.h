@@ -1,5 +1,7 @@
 // include/uptime.h
 #ifndef UPTIME_H
 #define UPTIME_H
-void uptime_string(char* out, size_t n);
+#include "fact.h"
+void uptime_fact(uf_fact_t* f);   // seconds
+void uptime_text(const uf_fact_t* f, char* out, size_t n);
 #endif
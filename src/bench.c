@@ -0,0 +1,162 @@
+// src/bench.c — --bench: per-module timing and I/O accounting
+#include "common.h"
+#include "bench.h"
+#include "module.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <dirent.h>
+#include <sys/resource.h>
+
+typedef struct {
+    unsigned long long syscr;   // read syscalls
+    unsigned long long rchar;   // bytes read, pipes included
+    size_t self;                // bytes this sample's own read() returned
+    int ok;
+} io_sample_t;
+
+// Process-wide read accounting from the kernel. Opened directly, not through
+// the I/O layer: a sysroot or a replay must not redirect the measurement.
+static io_sample_t io_sample(void){
+    io_sample_t s = { 0, 0, 0, 0 };
+    char buf[512];
+    int fd = open("/proc/self/io", O_RDONLY | O_CLOEXEC);
+    if(fd < 0) return s;
+    ssize_t got = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if(got <= 0) return s;
+    buf[got] = 0;
+
+    char* p = strstr(buf, "rchar:");
+    char* q = strstr(buf, "syscr:");
+    if(!p || !q) return s;
+    s.rchar = strtoull(p + 6, NULL, 10);
+    s.syscr = strtoull(q + 6, NULL, 10);
+    s.self = (size_t)got;
+    s.ok = 1;
+    return s;
+}
+
+// Child processes as the kernel sees them, whoever created them and whether
+// or not --allow-spawn was asked: live or unreaped ones are listed under
+// /proc/self/task/*/children, and each reaped one has added at least one
+// page fault to RUSAGE_CHILDREN (cminflt in /proc/self/stat).
+typedef struct {
+    long faults;
+    int live;
+} kids_sample_t;
+
+static kids_sample_t kids_sample(void){
+    kids_sample_t s = { 0, 0 };
+    struct rusage kids;
+    if(getrusage(RUSAGE_CHILDREN, &kids) == 0) s.faults = kids.ru_minflt + kids.ru_majflt;
+
+    DIR* tasks = opendir("/proc/self/task");
+    struct dirent* de;
+    while(tasks && (de = readdir(tasks)) != NULL){
+        if(de->d_name[0] == '.') continue;
+        char path[300], buf[512];
+        snprintf(path, sizeof(path), "/proc/self/task/%s/children", de->d_name);
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if(fd < 0) continue;
+        ssize_t got = read(fd, buf, sizeof(buf) - 1);
+        close(fd);
+        for(ssize_t i = 0; i < got; i++) if(buf[i] == ' ') s.live++;   // "pid pid "
+    }
+    if(tasks) closedir(tasks);
+    return s;
+}
+
+// Processes created between two samples; a reaped batch counts as one.
+static unsigned long kids_forked(kids_sample_t a, kids_sample_t b){
+    unsigned long n = b.live > a.live ? (unsigned long)(b.live - a.live) : 0;
+    return n + (b.faults != a.faults);
+}
+
+static double now_ms(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+// user + system time of this process and of its reaped children
+static double cpu_ms(void){
+    struct rusage self, kids;
+    getrusage(RUSAGE_SELF, &self);
+    getrusage(RUSAGE_CHILDREN, &kids);
+    double us = self.ru_utime.tv_sec * 1e6 + self.ru_utime.tv_usec +
+                self.ru_stime.tv_sec * 1e6 + self.ru_stime.tv_usec +
+                kids.ru_utime.tv_sec * 1e6 + kids.ru_utime.tv_usec +
+                kids.ru_stime.tv_sec * 1e6 + kids.ru_stime.tv_usec;
+    return us / 1e3;
+}
+
+static int cmp_double(const void* a, const void* b){
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+unsigned long long uf_bench_run(const int* ids, size_t count, int iterations){
+    if(iterations < 1) iterations = 1;
+    double* wall = malloc(sizeof(double) * (size_t)iterations);
+    if(!wall) return 0;
+    unsigned long long spawns = 0;
+
+    printf("%-10s %5s %9s %9s %9s %9s %9s %7s %7s %7s %10s %7s\n",
+           "module", "runs", "cold ms", "min ms", "med ms", "p99 ms", "cpu ms",
+           "opens", "io sys", "reads", "bytes", "spawns");
+
+    for(size_t k=0;k<count;k++){
+        const uf_module_t* m = &uf_modules[ids[k]];
+        uf_fact_t fact;
+        double cpu = 0;
+        unsigned long long reads = 0, bytes = 0;
+        int io_ok = 1;
+        unsigned long forks = 0;
+        uf_io_count_t before, after;
+        uf_io_count(&before);
+
+        for(int i=0;i<iterations;i++){
+            kids_sample_t k0 = kids_sample();
+            io_sample_t s0 = io_sample();
+            double c = cpu_ms();
+            double t = now_ms();
+
+            uf_deadline_begin(m->deadline_ms);
+            uf_module_collect(ids[k], &fact);
+
+            wall[i] = now_ms() - t;
+            cpu += cpu_ms() - c;
+            io_sample_t s1 = io_sample();
+            forks += kids_forked(k0, kids_sample());
+            io_ok = io_ok && s0.ok && s1.ok;
+            // the counters are bumped once a read returns, so s1 includes
+            // exactly one read of s0's size that the module did not do
+            if(s1.syscr > s0.syscr) reads += s1.syscr - s0.syscr - 1;
+            if(s1.rchar > s0.rchar + s0.self) bytes += s1.rchar - s0.rchar - s0.self;
+        }
+        uf_io_count(&after);
+
+        // the first run builds the cpuinfo, props and pci.ids indexes and
+        // fills the dirfd cache; the statistics cover the runs after it
+        double cold = wall[0];
+        double* warm = iterations > 1 ? wall + 1 : wall;
+        int n = iterations > 1 ? iterations - 1 : 1;
+        qsort(warm, (size_t)n, sizeof(double), cmp_double);
+
+        int p99 = (int)((n * 99 + 99) / 100) - 1;
+        double runs = iterations;
+        printf("%-10s %5d %9.3f %9.3f %9.3f %9.3f %9.3f %7.1f %7.1f ",
+               m->key, iterations, cold, warm[0], warm[n / 2], warm[p99], cpu / runs,
+               (after.opens - before.opens) / runs, (after.syscalls - before.syscalls) / runs);
+        if(io_ok) printf("%7.1f %10.0f ", reads / runs, bytes / runs);
+        else printf("%7s %10s ", "-", "-");
+        printf("%7.1f\n", forks / runs);
+        spawns += forks;
+    }
+    free(wall);
+    return spawns;
+}
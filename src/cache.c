@@ -0,0 +1,176 @@
+// src/cache.c — on-disk fact cache for slow, boot-stable modules
+#include "common.h"
+#include "cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#define CACHE_MAGIC "xfetch-cache 2\n"
+#define CACHE_MAX_ENTRIES 32
+#define CACHE_MAX_FILE (64 * 1024)
+
+typedef struct {
+    char key[32];
+    char validator[256];
+    char value[1024];   // an encoded fact (fact.h)
+} cache_entry_t;
+
+static cache_entry_t s_entries[CACHE_MAX_ENTRIES];
+static int s_count = 0;
+static int s_dirty = 0;
+static char s_boot_id[64];
+static int s_disabled = 0;
+
+static int cache_dir(char* out, size_t n){
+    const char* xdg = getenv("XDG_CACHE_HOME");
+    if(xdg && *xdg){
+        snprintf(out, n, "%s/xfetch", xdg);
+        return 1;
+    }
+    const char* home = getenv("HOME");
+    if(home && *home){
+        snprintf(out, n, "%s/.cache/xfetch", home);
+        return 1;
+    }
+    return 0;
+}
+
+void uf_cache_disable(void){
+    s_disabled = 1;
+}
+
+int uf_cache_dir(char* out, size_t n, int create){
+    if(s_disabled || !cache_dir(out, n)) return 0;
+    if(!create) return 1;
+
+    // mkdir -p for the two levels we may own ($HOME/.cache and .../xfetch)
+    char parent[512];
+    snprintf(parent, sizeof(parent), "%s", out);
+    char* slash = strrchr(parent, '/');
+    if(slash && slash != parent){ *slash = 0; mkdir(parent, 0700); }
+    return mkdir(out, 0700) == 0 || errno == EEXIST;
+}
+
+// copy one tab/newline separated field, returning the position after it
+static char* take_field(char* p, char* out, size_t n){
+    size_t i = 0;
+    while(*p && *p != '\t' && *p != '\n'){
+        if(i + 1 < n) out[i++] = *p;
+        p++;
+    }
+    out[i] = 0;
+    return *p ? p + 1 : p;
+}
+
+static void copy_clean(char* dst, size_t n, const char* src){
+    size_t i = 0;
+    for(; src && src[i] && i + 1 < n; i++)
+        dst[i] = (src[i] == '\t' || src[i] == '\n') ? ' ' : src[i];
+    dst[i] = 0;
+}
+
+void uf_cache_load(void){
+    s_count = 0;
+    s_dirty = 0;
+    if(!uf_read_first_line("/proc/sys/kernel/random/boot_id", s_boot_id, sizeof(s_boot_id)))
+        s_boot_id[0] = 0;
+
+    char dir[512], path[600];
+    if(!cache_dir(dir, sizeof(dir))) return;
+    snprintf(path, sizeof(path), "%s/facts", dir);
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if(fd < 0) return;
+    char* buf = malloc(CACHE_MAX_FILE + 1);
+    if(!buf){ close(fd); return; }
+    ssize_t len = read(fd, buf, CACHE_MAX_FILE);
+    close(fd);
+    if(len <= 0){ free(buf); return; }
+    buf[len] = 0;
+
+    size_t magic_len = strlen(CACHE_MAGIC);
+    if((size_t)len < magic_len || memcmp(buf, CACHE_MAGIC, magic_len) != 0){ free(buf); return; }
+
+    char* p = buf + magic_len;
+    while(*p && s_count < CACHE_MAX_ENTRIES){
+        cache_entry_t* e = &s_entries[s_count];
+        p = take_field(p, e->key, sizeof(e->key));
+        p = take_field(p, e->validator, sizeof(e->validator));
+        p = take_field(p, e->value, sizeof(e->value));
+        if(e->key[0]) s_count++;
+    }
+    free(buf);
+}
+
+static void full_validator(const char* validator, char* out, size_t n){
+    snprintf(out, n, "%s|%s", s_boot_id, validator ? validator : "");
+}
+
+int uf_cache_get(const char* key, const char* validator, char* out, size_t n){
+    // without a boot id we cannot tell when a fact went stale
+    if(!s_boot_id[0] || !key || !out || n == 0) return 0;
+    char full[256], clean[256];
+    full_validator(validator, full, sizeof(full));
+    copy_clean(clean, sizeof(clean), full);
+    for(int i=0;i<s_count;i++){
+        if(strcmp(s_entries[i].key, key) != 0) continue;
+        if(strcmp(s_entries[i].validator, clean) != 0) return 0;
+        snprintf(out, n, "%s", s_entries[i].value);
+        return 1;
+    }
+    return 0;
+}
+
+void uf_cache_put(const char* key, const char* validator, const char* value){
+    if(!s_boot_id[0] || !key || !value || !value[0]) return;
+    cache_entry_t* e = NULL;
+    for(int i=0;i<s_count;i++){
+        if(strcmp(s_entries[i].key, key) == 0){ e = &s_entries[i]; break; }
+    }
+    if(!e){
+        if(s_count >= CACHE_MAX_ENTRIES) return;
+        e = &s_entries[s_count++];
+    }
+    char full[256];
+    full_validator(validator, full, sizeof(full));
+    copy_clean(e->key, sizeof(e->key), key);
+    copy_clean(e->validator, sizeof(e->validator), full);
+    copy_clean(e->value, sizeof(e->value), value);
+    s_dirty = 1;
+}
+
+void uf_cache_save(void){
+    if(!s_dirty) return;
+    char dir[512], path[600], tmp[640];
+    if(!uf_cache_dir(dir, sizeof(dir), 1)) return;
+
+    snprintf(path, sizeof(path), "%s/facts", dir);
+    snprintf(tmp, sizeof(tmp), "%s/facts.%ld.tmp", dir, (long)getpid());
+
+    FILE* f = fopen(tmp, "w");
+    if(!f) return;
+    fputs(CACHE_MAGIC, f);
+    for(int i=0;i<s_count;i++)
+        fprintf(f, "%s\t%s\t%s\n", s_entries[i].key, s_entries[i].validator, s_entries[i].value);
+    if(fclose(f) != 0 || rename(tmp, path) != 0){
+        unlink(tmp);
+        return;
+    }
+    s_dirty = 0;
+}
+
+void uf_cache_stamp_file(const char* path, char* out, size_t n){
+    if(!out || n == 0) return;
+    struct stat st;
+    size_t len = strlen(out);
+    if(len >= n) return;
+    if(path && stat(path, &st) == 0)
+        snprintf(out + len, n - len, "%s@%llu:%lld;", path,
+                 (unsigned long long)st.st_ino, (long long)st.st_mtime);
+    else
+        snprintf(out + len, n - len, "%s@-;", path ? path : "");
+}
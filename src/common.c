@@ -1,11 +1,462 @@
 #include "common.h"
+#include "props.h"
+#include "record.h"
+#include "trace.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <limits.h>
+#include <math.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <sys/sysinfo.h>
 
 int UF_USE_ICONS = 1;
 int UF_IS_ANDROID = 0;
+long long UF_DEADLINE_MS = 0;
+int UF_ALLOW_SPAWN = 0;
+
+static _Thread_local long long tl_deadline_ms = 0;
+static _Thread_local int tl_timed_out = 0;
+
+static _Thread_local uf_io_count_t tl_io;
+
+static char uf_sysroot_dir[PATH_MAX];
+
+void uf_sysroot_set(const char* dir){
+    uf_sysroot_dir[0] = 0;
+    if(!dir || !*dir) return;
+    snprintf(uf_sysroot_dir, sizeof(uf_sysroot_dir), "%s", dir);
+    // "/a/b/" + "/proc/..." would still work, but keep rewritten paths tidy
+    size_t len = strlen(uf_sysroot_dir);
+    while(len > 1 && uf_sysroot_dir[len-1] == '/') uf_sysroot_dir[--len] = 0;
+    if(strcmp(uf_sysroot_dir, "/") == 0) uf_sysroot_dir[0] = 0;
+}
+
+const char* uf_sysroot(void){
+    return uf_sysroot_dir;
+}
+
+const char* uf_path(const char* path, char* buf, size_t n){
+    if(!path || !uf_sysroot_dir[0] || path[0] != '/') return path;
+    int w = snprintf(buf, n, "%s%s", uf_sysroot_dir, path);
+    if(w < 0 || (size_t)w >= n){ errno = ENAMETOOLONG; return NULL; }
+    return buf;
+}
+
+#define UF_SLURP_MAX (16u << 20)
+#define UF_DIRFD_MAX 64
+
+// Parent directories the collectors keep coming back to, opened O_PATH once
+// and kept for the life of the process. Entries are never evicted; once the
+// table is full further parents are opened per read.
+static pthread_mutex_t dirfd_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct { char* path; int fd; } dirfd_cache[UF_DIRFD_MAX];
+static size_t dirfd_used;
+
+// fd for `dir`, or -1. *owned is set when the caller has to close it.
+static int dirfd_get(const char* dir, int* owned){
+    *owned = 0;
+    pthread_mutex_lock(&dirfd_lock);
+    for(size_t i=0;i<dirfd_used;i++){
+        if(strcmp(dirfd_cache[i].path, dir) == 0){
+            int fd = dirfd_cache[i].fd;
+            pthread_mutex_unlock(&dirfd_lock);
+            return fd;
+        }
+    }
+    char buf[PATH_MAX];
+    const char* p = uf_path(dir, buf, sizeof(buf));
+    int fd = p ? open(p, O_PATH | O_DIRECTORY | O_CLOEXEC) : -1;
+    tl_io.syscalls++;
+    if(fd >= 0){
+        char* key = dirfd_used < UF_DIRFD_MAX ? strdup(dir) : NULL;
+        if(key){
+            dirfd_cache[dirfd_used].path = key;
+            dirfd_cache[dirfd_used].fd = fd;
+            dirfd_used++;
+        }
+        else *owned = 1;
+    }
+    pthread_mutex_unlock(&dirfd_lock);
+    return fd;
+}
+
+// Open dir/name for reading, or the absolute path `name` when dir is NULL
+// (its parent is then the cached directory).
+static int live_open(const char* dir, const char* name){
+    char parent[PATH_MAX];
+    const char* leaf = name;
+    if(!dir){
+        const char* slash = strrchr(name, '/');
+        size_t plen = slash ? (size_t)(slash - name) : 0;
+        if(name[0] != '/' || plen == 0 || plen >= sizeof(parent)){
+            char buf[PATH_MAX];
+            const char* p = uf_path(name, buf, sizeof(buf));
+            tl_io.syscalls++;
+            return p ? open(p, O_RDONLY | O_CLOEXEC) : -1;
+        }
+        memcpy(parent, name, plen);
+        parent[plen] = 0;
+        dir = parent;
+        leaf = slash + 1;
+    }
+
+    int owned;
+    int dfd = dirfd_get(dir, &owned);
+    if(dfd < 0) return -1;
+    int fd = openat(dfd, leaf, O_RDONLY | O_CLOEXEC);
+    tl_io.syscalls++;
+    if(owned){ close(dfd); tl_io.syscalls++; }
+    return fd;
+}
+
+static void live_close(int fd){
+    close(fd);
+    tl_io.syscalls++;
+}
+
+// Up to n bytes of fd from offset off; procfs and sysfs files report
+// st_size 0, so this reads to EOF rather than trusting fstat.
+static size_t live_pread(int fd, char* out, size_t n, off_t off){
+    size_t got = 0;
+    while(got < n){
+        ssize_t r = pread(fd, out + got, n - got, off + (off_t)got);
+        tl_io.syscalls++;
+        if(r < 0 && errno == EINTR) continue;
+        if(r <= 0) break;
+        got += (size_t)r;
+    }
+    return got;
+}
+
+// The whole of fd (capped at UF_SLURP_MAX) in a malloc'd, NUL-terminated buffer.
+static char* live_slurp(int fd, size_t* len){
+    for(int attempt = 0; ; attempt++){
+        struct stat st;
+        size_t cap = 4096;
+        int regular = fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0;
+        tl_io.syscalls++;
+        if(regular && (size_t)st.st_size < UF_SLURP_MAX) cap = (size_t)st.st_size + 1;
+
+        size_t got = 0;
+        char* buf = malloc(cap);
+        while(buf){
+            got += live_pread(fd, buf + got, cap - 1 - got, (off_t)got);
+            if(got < cap - 1 || cap >= UF_SLURP_MAX) break;
+            char* grown = realloc(buf, cap * 2);
+            if(!grown) break;
+            buf = grown;
+            cap *= 2;
+        }
+        if(!buf) return NULL;
+        // a regular file has to come back at its stat size; anything else
+        // means it changed under us, so take one fresh look
+        if(regular && got != (size_t)st.st_size && got < UF_SLURP_MAX - 1 && attempt == 0){
+            free(buf);
+            continue;
+        }
+        buf[got] = 0;
+        *len = got;
+        return buf;
+    }
+}
+
+// Record mode: read the whole file once and hand out the stored copy.
+// Returns 0 if the path is missing.
+static int snap_capture(const char* key, const char** data, size_t* len){
+    int fd = live_open(NULL, key);
+    if(fd < 0){ uf_snap_put(UF_SNAP_FILE, key, NULL, 0, 1); return 0; }
+    size_t got = 0;
+    char* tmp = live_slurp(fd, &got);
+    live_close(fd);
+
+    *data = uf_snap_put(UF_SNAP_FILE, key, tmp, got, 0);
+    *len = got;
+    free(tmp);
+    return *data != NULL;
+}
+
+static int snap_file(const char* path, const char** data, size_t* len){
+    if(UF_SNAP_MODE == UF_SNAP_REPLAY) return uf_snap_get(UF_SNAP_FILE, path, data, len);
+    return snap_capture(path, data, len);
+}
+
+// Snapshots are keyed by the absolute path, whichever call read it.
+static const char* snap_key(const char* dir, const char* name, char* buf, size_t n){
+    if(!dir) return name;
+    int w = snprintf(buf, n, "%s/%s", dir, name);
+    return w < 0 || (size_t)w >= n ? NULL : buf;
+}
+
+void uf_io_count(uf_io_count_t* out){
+    *out = tl_io;
+}
+
+static ssize_t read_into(const char* dir, const char* name, char* out, size_t n){
+    if(!name || !out || n == 0) return -1;
+    out[0] = 0;
+    tl_io.opens++;
+
+    if(UF_SNAP_MODE != UF_SNAP_OFF){
+        char buf[PATH_MAX];
+        const char* key = snap_key(dir, name, buf, sizeof(buf));
+        const char* data;
+        size_t len;
+        if(!key || !snap_file(key, &data, &len)) return -1;
+        if(len > n - 1) len = n - 1;
+        memcpy(out, data, len);
+        out[len] = 0;
+        return (ssize_t)len;
+    }
+
+    int fd = live_open(dir, name);
+    if(fd < 0) return -1;
+    size_t got = live_pread(fd, out, n - 1, 0);
+    live_close(fd);
+    out[got] = 0;
+    return (ssize_t)got;
+}
+
+ssize_t uf_read_file(const char* path, char* out, size_t n){
+    return read_into(NULL, path, out, n);
+}
+
+ssize_t uf_read_file_at(const char* dir, const char* name, char* out, size_t n){
+    if(!dir) return -1;
+    return read_into(dir, name, out, n);
+}
+
+int uf_read_value(const char* dir, const char* name, char* out, size_t n){
+    if(read_into(dir, name, out, n) <= 0) return 0;
+    uf_trim(out);
+    return out[0] != 0;
+}
+
+char* uf_read_file_alloc(const char* path, size_t* len){
+    if(!path) return NULL;
+    tl_io.opens++;
+    size_t got = 0;
+    char* buf = NULL;
+
+    if(UF_SNAP_MODE != UF_SNAP_OFF){
+        const char* data;
+        if(!snap_file(path, &data, &got)) return NULL;
+        buf = malloc(got + 1);
+        if(!buf) return NULL;
+        memcpy(buf, data, got);
+        buf[got] = 0;
+    } else {
+        int fd = live_open(NULL, path);
+        if(fd < 0) return NULL;
+        buf = live_slurp(fd, &got);
+        live_close(fd);
+    }
+    if(buf && len) *len = got;
+    return buf;
+}
+
+const char* uf_map_file(const char* path, size_t* len){
+    if(!path || !len) return NULL;
+    tl_io.opens++;
+    *len = 0;
+
+    if(UF_SNAP_MODE != UF_SNAP_OFF){
+        const char* data;
+        if(!snap_file(path, &data, len) || *len == 0) return NULL;
+        return data;
+    }
+
+    int fd = live_open(NULL, path);
+    if(fd < 0) return NULL;
+    struct stat st;
+    void* map = MAP_FAILED;
+    if(fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+        map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    tl_io.syscalls += 2;
+    live_close(fd);
+    if(map == MAP_FAILED) return NULL;
+    *len = (size_t)st.st_size;
+    return map;
+}
+
+void uf_unmap_file(const void* data, size_t len){
+    if(!data || UF_SNAP_MODE != UF_SNAP_OFF) return;
+    munmap((void*)data, len);
+}
+
+struct uf_dir {
+    DIR* live;
+    const char* list;   // snapshot listing: "<d_type><name>\0" runs
+    size_t len;
+    size_t pos;
+};
+
+uf_dir_t* uf_dir_open(const char* path){
+    const char* list = NULL;
+    size_t len = 0;
+    DIR* live = NULL;
+    tl_io.opens++;
+
+    if(UF_SNAP_MODE == UF_SNAP_REPLAY){
+        if(!uf_snap_get(UF_SNAP_DIR, path, &list, &len)){ errno = ENOENT; return NULL; }
+    } else {
+        char buf[PATH_MAX];
+        const char* p = uf_path(path, buf, sizeof(buf));
+        live = p ? opendir(p) : NULL;
+        if(UF_SNAP_MODE == UF_SNAP_RECORD){
+            if(!live){ uf_snap_put(UF_SNAP_DIR, path, NULL, 0, 1); return NULL; }
+            // capture the full listing even if the caller stops early
+            size_t cap = 1024, used = 0;
+            char* tmp = malloc(cap);
+            struct dirent* e;
+            while(tmp && (e = readdir(live)) != NULL){
+                if(!strcmp(e->d_name, ".") || !strcmp(e->d_name, "..")) continue;
+                size_t need = strlen(e->d_name) + 2;
+                if(used + need > cap){
+                    char* grown = realloc(tmp, cap * 2 + need);
+                    if(!grown) break;
+                    tmp = grown;
+                    cap = cap * 2 + need;
+                }
+                tmp[used] = (char)e->d_type;
+                memcpy(tmp + used + 1, e->d_name, need - 1);
+                used += need;
+            }
+            closedir(live);
+            live = NULL;
+            list = uf_snap_put(UF_SNAP_DIR, path, tmp, used, 0);
+            len = used;
+            free(tmp);
+            if(!list) return NULL;
+        }
+        else if(!live) return NULL;
+    }
+
+    uf_dir_t* d = calloc(1, sizeof(*d));
+    if(!d){ if(live) closedir(live); return NULL; }
+    d->live = live;
+    d->list = list;
+    d->len = len;
+    return d;
+}
+
+const char* uf_dir_next(uf_dir_t* d, unsigned char* type){
+    if(!d) return NULL;
+    if(d->live){
+        struct dirent* e;
+        while((e = readdir(d->live)) != NULL){
+            if(!strcmp(e->d_name, ".") || !strcmp(e->d_name, "..")) continue;
+            if(type) *type = e->d_type;
+            return e->d_name;
+        }
+        return NULL;
+    }
+    if(d->pos + 1 >= d->len) return NULL;
+    const char* rec = d->list + d->pos;
+    size_t name_len = strnlen(rec + 1, d->len - d->pos - 1);
+    if(type) *type = (unsigned char)rec[0];
+    d->pos += name_len + 2;
+    return rec + 1;
+}
+
+void uf_dir_close(uf_dir_t* d){
+    if(!d) return;
+    if(d->live) closedir(d->live);
+    free(d);
+}
+
+int uf_access(const char* path, int mode){
+    if(UF_SNAP_MODE == UF_SNAP_REPLAY){
+        const char* data;
+        size_t len;
+        if(uf_snap_get(UF_SNAP_EXIST, path, &data, &len)) return 0;
+        errno = ENOENT;
+        return -1;
+    }
+    char buf[PATH_MAX];
+    const char* p = uf_path(path, buf, sizeof(buf));
+    int r = p ? access(p, mode) : -1;
+    if(UF_SNAP_MODE == UF_SNAP_RECORD) uf_snap_put(UF_SNAP_EXIST, path, NULL, 0, r != 0);
+    return r;
+}
+
+ssize_t uf_readlink(const char* path, char* out, size_t n){
+    if(!path || !out || n == 0) return -1;
+    out[0] = 0;
+    const char* data;
+    size_t len;
+    if(UF_SNAP_MODE == UF_SNAP_REPLAY){
+        if(!uf_snap_get(UF_SNAP_LINK, path, &data, &len)) return -1;
+    } else {
+        char buf[PATH_MAX], target[PATH_MAX];
+        const char* p = uf_path(path, buf, sizeof(buf));
+        ssize_t r = p ? readlink(p, target, sizeof(target)) : -1;
+        if(UF_SNAP_MODE == UF_SNAP_RECORD)
+            uf_snap_put(UF_SNAP_LINK, path, target, r > 0 ? (size_t)r : 0, r <= 0);
+        if(r <= 0) return -1;
+        data = target;
+        len = (size_t)r;
+    }
+    if(len > n - 1) len = n - 1;
+    memcpy(out, data, len);
+    out[len] = 0;
+    return (ssize_t)len;
+}
+
+// uname()/sysinfo() results are kept raw: a snapshot replays on the same ABI
+static int snap_call(const char* key, void* out, size_t size, int live_rc){
+    if(UF_SNAP_MODE == UF_SNAP_RECORD){
+        uf_snap_put(UF_SNAP_CALL, key, out, size, live_rc != 0);
+        return live_rc;
+    }
+    const char* data;
+    size_t len;
+    if(!uf_snap_get(UF_SNAP_CALL, key, &data, &len) || len != size){
+        memset(out, 0, size);
+        errno = ENOSYS;
+        return -1;
+    }
+    memcpy(out, data, size);
+    return 0;
+}
+
+// Under --sysroot the kernel identity comes from the tree, so an aarch64
+// capture is probed as aarch64 on an x86_64 host.
+static void sysroot_uname(struct utsname* u){
+    char buf[sizeof(u->release)];
+    if(uf_read_first_line("/proc/sys/kernel/ostype", buf, sizeof(buf)) && buf[0])
+        snprintf(u->sysname, sizeof(u->sysname), "%s", buf);
+    if(uf_read_first_line("/proc/sys/kernel/osrelease", buf, sizeof(buf)) && buf[0])
+        snprintf(u->release, sizeof(u->release), "%s", buf);
+    if(uf_read_first_line("/proc/sys/kernel/arch", buf, sizeof(buf)) && buf[0])
+        snprintf(u->machine, sizeof(u->machine), "%s", buf);
+}
+
+int uf_uname(struct utsname* u){
+    if(UF_SNAP_MODE == UF_SNAP_REPLAY) return snap_call("uname", u, sizeof(*u), 0);
+    int rc = uname(u);
+    if(rc == 0 && uf_sysroot()[0]) sysroot_uname(u);
+    return UF_SNAP_MODE == UF_SNAP_RECORD ? snap_call("uname", u, sizeof(*u), rc) : rc;
+}
+
+int uf_sysinfo(struct sysinfo* si){
+    if(UF_SNAP_MODE == UF_SNAP_REPLAY) return snap_call("sysinfo", si, sizeof(*si), 0);
+    int rc = sysinfo(si);
+    return UF_SNAP_MODE == UF_SNAP_RECORD ? snap_call("sysinfo", si, sizeof(*si), rc) : rc;
+}
 
 void uf_trim(char* s){
     if(!s) return;
@@ -16,23 +467,17 @@ void uf_trim(char* s){
 }
 
 char* uf_read_first_line(const char* path, char* buf, size_t n){
-    FILE* f = fopen(path, "r");
-    if(!f) return NULL;
-    if(!fgets(buf, (int)n, f)){ fclose(f); return NULL; }
-    fclose(f);
+    if(uf_read_file(path, buf, n) <= 0) return NULL;
+    buf[strcspn(buf, "\n")] = 0;
     uf_trim(buf);
     return buf;
 }
 
 char* uf_exec_read(const char* cmd, char* buf, size_t n){
-    FILE* p = popen(cmd, "r");
-    if(!p) return NULL;
-    size_t m = fread(buf, 1, n-1, p);
-    pclose(p);
-    if(m == 0){ buf[0]=0; return NULL; }
-    buf[m] = 0;
+    int m = uf_spawn_read(cmd, buf, n);
+    if(m <= 0){ buf[0]=0; return NULL; }
     // cut at newline
-    for(size_t i=0;i<m;i++){ if(buf[i]=='\n'){ buf[i]=0; break; } }
+    for(int i=0;i<m;i++){ if(buf[i]=='\n'){ buf[i]=0; break; } }
     uf_trim(buf);
     return buf;
 }
@@ -44,9 +489,251 @@ void uf_human_bytes(unsigned long long bytes, char out[32]){
     snprintf(out, 32, "%.1f %s", v, sfx[i]);
 }
 
+static void json_raw(uf_json_t* j, const char* s, size_t n){
+    if(j->overflow) return;
+    if(n > j->cap - j->len){ j->overflow = 1; return; }
+    memcpy(j->buf + j->len, s, n);
+    j->len += n;
+}
+
+// Quoted and escaped; runs of plain bytes (UTF-8 included) go in one copy.
+static void json_quoted(uf_json_t* j, const char* s){
+    static const char hex[] = "0123456789abcdef";
+    json_raw(j, "\"", 1);
+    const char* run = s;
+    for(; *s; s++){
+        unsigned char c = (unsigned char)*s;
+        if(c >= 0x20 && c != '"' && c != '\\') continue;
+        json_raw(j, run, (size_t)(s - run));
+        run = s + 1;
+        char esc[6] = { '\\', (char)c, 0 };
+        size_t n = 2;
+        switch(c){
+        case '"': case '\\': break;
+        case '\n': esc[1] = 'n'; break;
+        case '\t': esc[1] = 't'; break;
+        case '\r': esc[1] = 'r'; break;
+        default:
+            memcpy(esc + 1, "u00", 3);
+            esc[4] = hex[c >> 4];
+            esc[5] = hex[c & 15];
+            n = 6;
+        }
+        json_raw(j, esc, n);
+    }
+    json_raw(j, run, (size_t)(s - run));
+    json_raw(j, "\"", 1);
+}
+
+static void json_key(uf_json_t* j, const char* key){
+    if(j->depth == 0) return;
+    if(j->more[j->depth]) json_raw(j, ",", 1);
+    j->more[j->depth] = 1;
+    if(j->close[j->depth] == '}'){
+        json_quoted(j, key ? key : "");
+        json_raw(j, ":", 1);
+    }
+}
+
+static void json_open(uf_json_t* j, const char* key, char open, char close){
+    json_key(j, key);
+    if(j->depth + 1 >= UF_JSON_DEPTH){ j->overflow = 1; return; }
+    json_raw(j, &open, 1);
+    j->depth++;
+    j->more[j->depth] = 0;
+    j->close[j->depth] = close;
+}
+
+void uf_json_init(uf_json_t* j, char* buf, size_t cap){
+    memset(j, 0, sizeof(*j));
+    j->buf = buf;
+    j->cap = cap;
+}
+
+void uf_json_object(uf_json_t* j, const char* key){ json_open(j, key, '{', '}'); }
+void uf_json_array(uf_json_t* j, const char* key){ json_open(j, key, '[', ']'); }
+
+void uf_json_end(uf_json_t* j){
+    if(j->depth == 0) return;
+    json_raw(j, &j->close[j->depth], 1);
+    j->depth--;
+}
+
+void uf_json_str(uf_json_t* j, const char* key, const char* s){
+    if(!s){ uf_json_null(j, key); return; }
+    json_key(j, key);
+    json_quoted(j, s);
+}
+
+void uf_json_int(uf_json_t* j, const char* key, long long v){
+    char num[24];
+    int n = snprintf(num, sizeof(num), "%lld", v);
+    json_key(j, key);
+    json_raw(j, num, (size_t)n);
+}
+
+void uf_json_num(uf_json_t* j, const char* key, double v){
+    if(!isfinite(v)){ uf_json_null(j, key); return; }
+    char num[32];
+    int n = snprintf(num, sizeof(num), "%.10g", v);
+    json_key(j, key);
+    json_raw(j, num, (size_t)n);
+}
+
+void uf_json_null(uf_json_t* j, const char* key){
+    json_key(j, key);
+    json_raw(j, "null", 4);
+}
+
 void uf_detect_android(void){
-    char buf[256];
-    buf[0]=0;
-    if(uf_exec_read("getprop ro.product.manufacturer 2>/dev/null", buf, sizeof(buf)))
-        if(buf[0]) UF_IS_ANDROID = 1;
+#ifdef __ANDROID__
+    UF_IS_ANDROID = 1;
+#else
+    // a build.prop naming a manufacturer; one failed access() on plain Linux
+    char buf[UF_PROP_VALUE_MAX];
+    UF_IS_ANDROID = uf_access("/system/build.prop", R_OK) == 0 &&
+                    uf_prop_get("ro.product.manufacturer", buf, sizeof(buf));
+#endif
+}
+
+long long uf_now_ms(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+void uf_deadline_begin(int budget_ms){
+    tl_deadline_ms = budget_ms > 0 ? uf_now_ms() + budget_ms : 0;
+    tl_timed_out = 0;
+}
+
+int uf_deadline_hit(void){
+    return tl_timed_out;
+}
+
+// effective deadline: the tighter of the module and the global budget
+static long long current_deadline(void){
+    long long d = tl_deadline_ms;
+    if(UF_DEADLINE_MS && (!d || UF_DEADLINE_MS < d)) d = UF_DEADLINE_MS;
+    return d;
+}
+
+static int remaining_ms(long long deadline){
+    if(!deadline) return -1;
+    long long left = deadline - uf_now_ms();
+    return left > 0 ? (int)left : 0;
+}
+
+static int spawn_live(const char* cmd, char* buf, size_t n);
+
+// Reap a child whose stdout has closed, waiting no later than the deadline.
+// -1 if the deadline came first and the child is still running.
+static int reap_by(pid_t pid, long long deadline){
+    int status;
+    if(deadline){
+        // a pidfd turns readable when the child exits
+        int pfd = (int)syscall(SYS_pidfd_open, pid, 0);
+        if(pfd >= 0){
+            struct pollfd p = { .fd = pfd, .events = POLLIN };
+            int r;
+            while((r = poll(&p, 1, remaining_ms(deadline))) < 0 && errno == EINTR) {}
+            close(pfd);
+            if(r == 0) return -1;
+        }else{
+            // no pidfd before Linux 5.3: look again every millisecond
+            while(waitpid(pid, &status, WNOHANG) == 0){
+                if(remaining_ms(deadline) == 0) return -1;
+                struct timespec ts = { 0, 1000000 };
+                nanosleep(&ts, NULL);
+            }
+            return 0;
+        }
+    }
+    while(waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+    return 0;
+}
+
+int uf_spawn_read(const char* cmd, char* buf, size_t n){
+    if(!cmd || !buf || n == 0) return -1;
+    buf[0] = 0;
+
+    if(UF_SNAP_MODE == UF_SNAP_REPLAY){
+        const char* data;
+        size_t len;
+        if(!uf_snap_get(UF_SNAP_CMD, cmd, &data, &len)) return -1;
+        if(len > n - 1) len = n - 1;
+        memcpy(buf, data, len);
+        buf[len] = 0;
+        return (int)len;
+    }
+    if(!UF_ALLOW_SPAWN) return -1;
+    int prev = tl_timed_out;
+    tl_timed_out = 0;
+    UF_TRACE_BEGIN_ARG("spawn", cmd);
+    int got = spawn_live(cmd, buf, n);
+    UF_TRACE_END();
+    // a timed-out probe is not an observation worth replaying
+    if(UF_SNAP_MODE == UF_SNAP_RECORD && !tl_timed_out)
+        uf_snap_put(UF_SNAP_CMD, cmd, buf, got > 0 ? (size_t)got : 0, got < 0);
+    tl_timed_out |= prev;
+    return got;
+}
+
+static int spawn_live(const char* cmd, char* buf, size_t n){
+
+    long long deadline = current_deadline();
+    if(deadline && remaining_ms(deadline) == 0){ tl_timed_out = 1; return -1; }
+
+    int fds[2];
+    if(pipe2(fds, O_CLOEXEC) != 0) return -1;
+
+    pid_t pid = fork();
+    if(pid < 0){ close(fds[0]); close(fds[1]); return -1; }
+    if(pid == 0){
+        // own process group so a timeout can take down the whole pipeline
+        setpgid(0, 0);
+        dup2(fds[1], STDOUT_FILENO);
+        execl("/bin/sh", "sh", "-c", cmd, (char*)NULL);
+        _exit(127);
+    }
+    setpgid(pid, pid);
+    close(fds[1]);
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+
+    size_t len = 0;
+    int timed_out = 0;
+    for(;;){
+        struct pollfd pfd = { .fd = fds[0], .events = POLLIN };
+        int r = poll(&pfd, 1, remaining_ms(deadline));
+        if(r < 0){
+            if(errno == EINTR) continue;
+            break;
+        }
+        if(r == 0){ timed_out = 1; break; }
+
+        char scratch[512];
+        char* dst = len + 1 < n ? buf + len : scratch;
+        size_t room = len + 1 < n ? n - 1 - len : sizeof(scratch);
+        ssize_t got = read(fds[0], dst, room);
+        if(got > 0){
+            if(dst != scratch) len += (size_t)got;   // overflow is drained and dropped
+            continue;
+        }
+        if(got < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+        break;   // EOF or error
+    }
+    close(fds[0]);
+    buf[len] = 0;
+
+    // stdout is closed; give the child until the deadline to exit
+    if(!timed_out && reap_by(pid, deadline) != 0) timed_out = 1;
+    if(timed_out){
+        int status;
+        kill(-pid, SIGKILL);
+        while(waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+        tl_timed_out = 1;
+        buf[0] = 0;
+        return -1;
+    }
+    return (int)len;
 }
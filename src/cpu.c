@@ -1,6 +1,13 @@
 #include "common.h"
 #include "cpu.h"
+#include "fact.h"
+#include "cpuinfo.h"
+#include "mapping.h"
+#include "props.h"
+#include "trace.h"
 #include <stdio.h>
+#include <stdarg.h>
+#include <stdint.h>
 #include <unistd.h>
 #include <string.h>
 #include <stdlib.h>
@@ -9,9 +16,9 @@
 #include <dirent.h>
 #include <errno.h>
 #include <sys/sysinfo.h>
+#include <sys/utsname.h>
 
 #define FF_CPU_TEMP_UNSET -1.0
-#define FF_CPUINFO_PATH "/proc/cpuinfo"
 
 typedef struct {
     char name[512];
@@ -23,6 +30,7 @@ typedef struct {
     int packages;
     float frequency_base;
     float frequency_max;
+    float frequency_current;
     int cache_l1d;
     int cache_l1i;
     int cache_l2;
@@ -32,19 +40,16 @@ typedef struct {
     char flags[1024];
 } cpu_result_t;
 
-static double parse_tz_dir(int dfd, char* buffer, size_t buf_size);
-static double parse_hwmon_dir(int dfd, char* buffer, size_t buf_size);
+static double parse_tz_dir(const char* dir, char* buffer, size_t buf_size);
+static double parse_hwmon_dir(const char* dir, char* buffer, size_t buf_size);
 static double detect_cpu_temp(void);
 static void detect_soc_mapping(cpu_result_t* cpu);
 static void detect_android(cpu_result_t* cpu);
-static const char* parse_cpu_info(char* cpuinfo_content, cpu_result_t* cpu);
+static const char* parse_cpu_info(cpu_result_t* cpu);
 static int detect_frequency(cpu_result_t* cpu);
 static void detect_physical_cores(cpu_result_t* cpu);
 static void detect_architecture(cpu_result_t* cpu);
 static const char* cpu_detect_impl(cpu_result_t* cpu);
-static int read_file_buffer(const char* path, char* buffer, size_t size);
-static int read_file_buffer_relative(int dfd, const char* filename, char* buffer, size_t size);
-static int parse_prop_line(const char* line, const char* key, char* output, size_t output_size);
 static void trim_string(char* str);
 static int string_starts_with(const char* str, const char* prefix);
 static int string_equals(const char* a, const char* b);
@@ -52,10 +57,9 @@ static int string_contains(const char* haystack, const char* needle);
 static int get_android_property(const char* prop, char* buffer, size_t size);
 static uint32_t get_frequency_value(const char* base_path, const char* file1, const char* file2);
 static int char_is_digit(char c);
-static const char* get_soc_name(const char* hardware_id);
 
-static double parse_tz_dir(int dfd, char* buffer, size_t buf_size) {
-    if (!read_file_buffer_relative(dfd, "type", buffer, buf_size))
+static double parse_tz_dir(const char* dir, char* buffer, size_t buf_size) {
+    if (!uf_read_value(dir, "type", buffer, buf_size))
         return FF_CPU_TEMP_UNSET;
 
     if (!string_starts_with(buffer, "cpu") &&
@@ -63,7 +67,7 @@ static double parse_tz_dir(int dfd, char* buffer, size_t buf_size) {
         !string_equals(buffer, "x86_pkg_temp"))
         return FF_CPU_TEMP_UNSET;
 
-    if (!read_file_buffer_relative(dfd, "temp", buffer, buf_size))
+    if (!uf_read_value(dir, "temp", buffer, buf_size))
         return FF_CPU_TEMP_UNSET;
 
     double value = strtod(buffer, NULL);
@@ -72,8 +76,8 @@ static double parse_tz_dir(int dfd, char* buffer, size_t buf_size) {
     return value / 1000.0;
 }
 
-static double parse_hwmon_dir(int dfd, char* buffer, size_t buf_size) {
-    if (!read_file_buffer_relative(dfd, "name", buffer, buf_size))
+static double parse_hwmon_dir(const char* dir, char* buffer, size_t buf_size) {
+    if (!uf_read_value(dir, "name", buffer, buf_size))
         return FF_CPU_TEMP_UNSET;
 
     trim_string(buffer);
@@ -84,7 +88,7 @@ static double parse_hwmon_dir(int dfd, char* buffer, size_t buf_size) {
         !string_equals(buffer, "coretemp"))
         return FF_CPU_TEMP_UNSET;
 
-    if (!read_file_buffer_relative(dfd, "temp1_input", buffer, buf_size))
+    if (!uf_read_value(dir, "temp1_input", buffer, buf_size))
         return FF_CPU_TEMP_UNSET;
 
     double value = strtod(buffer, NULL);
@@ -96,185 +100,56 @@ static double parse_hwmon_dir(int dfd, char* buffer, size_t buf_size) {
 static double detect_cpu_temp(void) {
     char buffer[256];
     
-    DIR* dirp = opendir("/sys/class/hwmon/");
+    char dir[300];
+    const char* name;
+    
+    UF_TRACE_BEGIN("cpu.temp.hwmon");
+    uf_dir_t* dirp = uf_dir_open("/sys/class/hwmon");
     if (dirp) {
-        int dfd = dirfd(dirp);
-        struct dirent* entry;
-        while ((entry = readdir(dirp)) != NULL) {
-            if (entry->d_name[0] == '.')
+        while ((name = uf_dir_next(dirp, NULL)) != NULL) {
+            if (name[0] == '.')
                 continue;
 
-            int subfd = openat(dfd, entry->d_name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
-            if (subfd < 0) continue;
-
-            double result = parse_hwmon_dir(subfd, buffer, sizeof(buffer));
-            close(subfd);
+            snprintf(dir, sizeof(dir), "/sys/class/hwmon/%s", name);
+            double result = parse_hwmon_dir(dir, buffer, sizeof(buffer));
             if (result != FF_CPU_TEMP_UNSET) {
-                closedir(dirp);
+                uf_dir_close(dirp);
+                UF_TRACE_END();
                 return result;
             }
         }
-        closedir(dirp);
+        uf_dir_close(dirp);
     }
+    UF_TRACE_END();
 
-    dirp = opendir("/sys/class/thermal/");
+    UF_TRACE_BEGIN("cpu.temp.thermal");
+    dirp = uf_dir_open("/sys/class/thermal");
     if (dirp) {
-        int dfd = dirfd(dirp);
-        struct dirent* entry;
-        while ((entry = readdir(dirp)) != NULL) {
-            if (entry->d_name[0] == '.')
+        while ((name = uf_dir_next(dirp, NULL)) != NULL) {
+            if (name[0] == '.')
                 continue;
-            if (!string_starts_with(entry->d_name, "thermal_zone"))
+            if (!string_starts_with(name, "thermal_zone"))
                 continue;
 
-            int subfd = openat(dfd, entry->d_name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
-            if (subfd < 0) continue;
-
-            double result = parse_tz_dir(subfd, buffer, sizeof(buffer));
-            close(subfd);
+            snprintf(dir, sizeof(dir), "/sys/class/thermal/%s", name);
+            double result = parse_tz_dir(dir, buffer, sizeof(buffer));
             if (result != FF_CPU_TEMP_UNSET) {
-                closedir(dirp);
+                uf_dir_close(dirp);
+                UF_TRACE_END();
                 return result;
             }
         }
-        closedir(dirp);
+        uf_dir_close(dirp);
     }
+    UF_TRACE_END();
 
     return FF_CPU_TEMP_UNSET;
 }
 
-static const char* get_qualcomm_name(const char* id) {
-    if (string_starts_with(id, "SM")) {
-        uint32_t code = (uint32_t)strtoul(id + 2, NULL, 10);
-        switch (code) {
-            case 8750: return "Qualcomm Snapdragon 8 Elite";
-            case 8650: return "Qualcomm Snapdragon 8 Gen 3";
-            case 8550: return "Qualcomm Snapdragon 8 Gen 2";
-            case 8475: return "Qualcomm Snapdragon 8+ Gen 1";
-            case 8450: return "Qualcomm Snapdragon 8 Gen 1";
-            case 8350: return "Qualcomm Snapdragon 888";
-            case 8250: return "Qualcomm Snapdragon 865";
-            case 8150: return "Qualcomm Snapdragon 855";
-            case 7550: return "Qualcomm Snapdragon 7 Gen 3";
-            case 7475: return "Qualcomm Snapdragon 7+ Gen 2";
-            case 7450: return "Qualcomm Snapdragon 7 Gen 1";
-            case 7325: return "Qualcomm Snapdragon 778G";
-            case 7250: return "Qualcomm Snapdragon 765G";
-            case 6650: return "Qualcomm Snapdragon 6 Gen 4";
-            case 6475: return "Qualcomm Snapdragon 6 Gen 3";
-            case 6450: return "Qualcomm Snapdragon 6 Gen 1";
-            case 6375: return "Qualcomm Snapdragon 695 5G";
-            case 6350: return "Qualcomm Snapdragon 690 5G";
-        }
-    }
-    return NULL;
-}
-
-static const char* get_mediatek_name(const char* id) {
-    if (string_starts_with(id, "MT")) {
-        uint32_t code = (uint32_t)strtoul(id + 2, NULL, 10);
-        switch (code) {
-            case 6991: return "MediaTek Dimensity 9400";
-            case 6989: case 8796: return "MediaTek Dimensity 9300";
-            case 6985: return "MediaTek Dimensity 9200";
-            case 6983: case 8798: return "MediaTek Dimensity 9000";
-            case 6899: return "MediaTek Dimensity 8400";
-            case 6897: case 8792: return "MediaTek Dimensity 8300";
-            case 6896: return "MediaTek Dimensity 8200";
-            case 8795: return "MediaTek Dimensity 8100";
-            case 6895: return "MediaTek Dimensity 8000";
-            case 6893: return "MediaTek Dimensity 1200";
-            case 6891: return "MediaTek Dimensity 1100";
-            case 6889: return "MediaTek Dimensity 1000+";
-            case 6877: return "MediaTek Dimensity 900";
-            case 6873: return "MediaTek Dimensity 800";
-            case 6853: return "MediaTek Dimensity 720";
-            case 6833: return "MediaTek Dimensity 700";
-            case 6789: return "Helio G99";
-            case 6785: return "Helio G90T";
-            case 6768: return "Helio G85";
-            case 6769: return "Helio G80";
-            case 6779: return "Helio P90";
-            case 6771: return "Helio P60";
-            case 6765: return "Helio P35";
-            case 6762: return "Helio P22";
-        }
-    }
-    return NULL;
-}
-
-static const char* get_exynos_name(const char* id) {
-    if (string_starts_with(id, "EXYNOS") || string_starts_with(id, "Exynos")) {
-        const char* num_start = id;
-        while (*num_start && !char_is_digit(*num_start)) num_start++;
-        uint32_t code = (uint32_t)strtoul(num_start, NULL, 10);
-        switch (code) {
-            case 2400: return "Samsung Exynos 2400";
-            case 2200: return "Samsung Exynos 2200";
-            case 2100: return "Samsung Exynos 2100";
-            case 990: return "Samsung Exynos 990";
-            case 9820: return "Samsung Exynos 9820";
-            case 9810: return "Samsung Exynos 9810";
-            case 8895: return "Samsung Exynos 8895";
-            case 1330: return "Samsung Exynos 1330";
-            case 1280: return "Samsung Exynos 1280";
-            case 850: return "Samsung Exynos 850";
-        }
-    }
-    return NULL;
-}
-
-static const char* get_other_soc_name(const char* id) {
-    if (string_starts_with(id, "BCM")) {
-        uint32_t code = (uint32_t)strtoul(id + 3, NULL, 10);
-        switch (code) {
-            case 2711: return "Broadcom BCM2711 (Raspberry Pi 4)";
-            case 2837: return "Broadcom BCM2837 (Raspberry Pi 3)";
-            case 2835: return "Broadcom BCM2835 (Raspberry Pi 1)";
-        }
-    }
-    
-    if (string_starts_with(id, "RK")) {
-        uint32_t code = (uint32_t)strtoul(id + 2, NULL, 10);
-        switch (code) {
-            case 3588: return "Rockchip RK3588";
-            case 3566: return "Rockchip RK3566";
-            case 3399: return "Rockchip RK3399";
-            case 3328: return "Rockchip RK3328";
-        }
-    }
-    
-    if (string_starts_with(id, "H")) {
-        uint32_t code = (uint32_t)strtoul(id + 1, NULL, 10);
-        switch (code) {
-            case 618: return "Allwinner H618";
-            case 616: return "Allwinner H616";
-            case 313: return "Allwinner H313";
-        }
-    }
-    
-    return NULL;
-}
-
-static const char* get_soc_name(const char* hardware_id) {
-    const char* result;
-    
-    if ((result = get_qualcomm_name(hardware_id)) != NULL)
-        return result;
-    if ((result = get_mediatek_name(hardware_id)) != NULL)
-        return result;
-    if ((result = get_exynos_name(hardware_id)) != NULL)
-        return result;
-    if ((result = get_other_soc_name(hardware_id)) != NULL)
-        return result;
-        
-    return NULL;
-}
-
 static void detect_soc_mapping(cpu_result_t* cpu) {
     if (strlen(cpu->name) == 0) return;
     
-    const char* mapped_name = get_soc_name(cpu->name);
+    const char* mapped_name = uf_map_soc_name(cpu->name);
     if (mapped_name) {
         char original[256];
         snprintf(original, sizeof(original), "%s", cpu->name);
@@ -305,7 +180,7 @@ static void detect_android(cpu_result_t* cpu) {
 static void detect_architecture(cpu_result_t* cpu) {
     char buffer[64] = {0};
     
-    if (read_file_buffer("/proc/sys/kernel/osrelease", buffer, sizeof(buffer))) {
+    if (uf_read_value(NULL, "/proc/sys/kernel/osrelease", buffer, sizeof(buffer))) {
         if (string_contains(buffer, "aarch64") || string_contains(buffer, "arm64")) {
             strcpy(cpu->arch, "aarch64");
         } else if (string_contains(buffer, "armv7") || string_contains(buffer, "armhf")) {
@@ -318,90 +193,141 @@ static void detect_architecture(cpu_result_t* cpu) {
     }
     
     if (strlen(cpu->arch) == 0) {
-        FILE* f = popen("uname -m 2>/dev/null", "r");
-        if (f) {
-            if (fgets(buffer, sizeof(buffer), f)) {
-                trim_string(buffer);
-                snprintf(cpu->arch, sizeof(cpu->arch), "%s", buffer);
-            }
-            pclose(f);
+        struct utsname uts;
+        if (uf_uname(&uts) == 0 && uts.machine[0]) {
+            snprintf(cpu->arch, sizeof(cpu->arch), "%.*s", (int)sizeof(cpu->arch) - 1, uts.machine);
         }
     }
 }
 
-static const char* parse_cpu_info(char* cpuinfo_content, cpu_result_t* cpu) {
-    char* line = strtok(cpuinfo_content, "\n");
-    
-    while (line != NULL) {
-        if (strlen(cpu->name) == 0) {
-            parse_prop_line(line, "model name", cpu->name, sizeof(cpu->name)) ||
-            parse_prop_line(line, "Hardware", cpu->name, sizeof(cpu->name)) ||
-            parse_prop_line(line, "cpu", cpu->name, sizeof(cpu->name)) ||
-            parse_prop_line(line, "cpu model", cpu->name, sizeof(cpu->name)) ||
-            parse_prop_line(line, "Model Name", cpu->name, sizeof(cpu->name));
-        }
+static const char* first_of(const char* a, const char* b) {
+    return a ? a : b;
+}
 
-        if (strlen(cpu->vendor) == 0) {
-            parse_prop_line(line, "vendor_id", cpu->vendor, sizeof(cpu->vendor)) ||
-            parse_prop_line(line, "vendor", cpu->vendor, sizeof(cpu->vendor));
-        }
+// Distinct core types from the MIDR fields, in processor order:
+// "Cortex-A76 + Cortex-A55" on a big.LITTLE part with no model name.
+static void arm_core_names(const uf_cpuinfo_t* info, char* out, size_t n) {
+    const char* seen[8];
+    size_t count = 0, len = 0;
+    out[0] = '\0';
+    for (size_t i = 0; i < info->count && count < sizeof(seen) / sizeof(seen[0]); i++) {
+        const uf_cpuinfo_proc_t* p = &info->procs[i];
+        if (!p->cpu_implementer || !p->cpu_part) continue;
+        const char* name = uf_map_arm_part((unsigned)strtoul(p->cpu_implementer, NULL, 0),
+                                           (unsigned)strtoul(p->cpu_part, NULL, 0));
+        if (!name) continue;
+        
+        size_t k = 0;
+        while (k < count && seen[k] != name) k++;
+        if (k < count) continue;
+        seen[count++] = name;
+        len += (size_t)snprintf(out + len, len < n ? n - len : 0, "%s%s", count > 1 ? " + " : "", name);
+    }
+}
 
-        if (cpu->frequency_base == 0) {
-            char freq_buf[64] = {0};
-            if (parse_prop_line(line, "cpu MHz", freq_buf, sizeof(freq_buf)) ||
-                parse_prop_line(line, "clock", freq_buf, sizeof(freq_buf)) ||
-                parse_prop_line(line, "CPU MHz", freq_buf, sizeof(freq_buf))) {
-                cpu->frequency_base = (float)atof(freq_buf);
-            }
-        }
+static const char* parse_cpu_info(cpu_result_t* cpu) {
+    const uf_cpuinfo_t* info = uf_cpuinfo();
+    if (!info) return "Failed to read /proc/cpuinfo";
 
-        if (strlen(cpu->flags) == 0) {
-            parse_prop_line(line, "flags", cpu->flags, sizeof(cpu->flags)) ||
-            parse_prop_line(line, "Features", cpu->flags, sizeof(cpu->flags));
-        }
+    // the first processor block describes the package; lines outside any
+    // block (older arm kernels) fill the gaps
+    const uf_cpuinfo_proc_t* p = info->count ? &info->procs[0] : &info->common;
+    const uf_cpuinfo_proc_t* c = &info->common;
 
-        line = strtok(NULL, "\n");
+    if (strlen(cpu->name) == 0) {
+        const char* name = first_of(first_of(p->model_name, c->model_name), info->hardware);
+        if (name) snprintf(cpu->name, sizeof(cpu->name), "%s", name);
+        else arm_core_names(info, cpu->name, sizeof(cpu->name));
+    }
+
+    if (strlen(cpu->vendor) == 0) {
+        const char* vendor = first_of(p->vendor, c->vendor);
+        if (vendor) snprintf(cpu->vendor, sizeof(cpu->vendor), "%s", vendor);
+    }
+
+    if (cpu->frequency_base == 0)
+        cpu->frequency_base = (float)(p->mhz > 0 ? p->mhz : c->mhz);
+
+    if (strlen(cpu->flags) == 0) {
+        const char* flags = first_of(p->flags, c->flags);
+        if (flags) snprintf(cpu->flags, sizeof(cpu->flags), "%s", flags);
     }
 
     return NULL;
 }
 
 static int detect_frequency(cpu_result_t* cpu) {
-    uint32_t max_freq = get_frequency_value("/sys/devices/system/cpu/cpu0/cpufreq", "/cpuinfo_max_freq", "/scaling_max_freq");
-    uint32_t base_freq = get_frequency_value("/sys/devices/system/cpu/cpu0/cpufreq", "/base_frequency", NULL);
-    uint32_t cur_freq = get_frequency_value("/sys/devices/system/cpu/cpu0/cpufreq", "/scaling_cur_freq", NULL);
+    uint32_t max_freq = get_frequency_value("/sys/devices/system/cpu/cpu0/cpufreq", "cpuinfo_max_freq", "scaling_max_freq");
+    uint32_t base_freq = get_frequency_value("/sys/devices/system/cpu/cpu0/cpufreq", "base_frequency", NULL);
+    uint32_t cur_freq = get_frequency_value("/sys/devices/system/cpu/cpu0/cpufreq", "scaling_cur_freq", NULL);
     
     if (max_freq > 0) cpu->frequency_max = (float)max_freq;
     if (base_freq > 0) cpu->frequency_base = (float)base_freq;
+    if (cur_freq > 0) cpu->frequency_current = (float)cur_freq;
     if (cur_freq > 0 && cpu->frequency_base == 0) cpu->frequency_base = (float)cur_freq;
     
     char governor[64] = {0};
-    if (read_file_buffer("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor", governor, sizeof(governor))) {
+    if (uf_read_value(NULL, "/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor", governor, sizeof(governor))) {
         snprintf(cpu->governor, sizeof(cpu->governor), "%s", governor);
     }
     
     return (max_freq > 0 || base_freq > 0) ? 1 : 0;
 }
 
+// "0-3,6,8-11" -> 10
+static int count_cpu_list(const char* list) {
+    int count = 0;
+    while (*list) {
+        char* end;
+        long lo = strtol(list, &end, 10);
+        if (end == list) break;
+        long hi = lo;
+        if (*end == '-') hi = strtol(end + 1, &end, 10);
+        if (hi >= lo) count += (int)(hi - lo + 1);
+        if (*end != ',') break;
+        list = end + 1;
+    }
+    return count;
+}
+
+static void detect_online_cores(cpu_result_t* cpu) {
+    char buffer[256];
+    if (uf_read_value(NULL, "/sys/devices/system/cpu/online", buffer, sizeof(buffer)))
+        cpu->cores_online = count_cpu_list(buffer);
+}
+
 static void detect_physical_cores(cpu_result_t* cpu) {
-    DIR* dir = opendir("/sys/devices/system/cpu/");
-    if (!dir) return;
+    uf_dir_t* dir = uf_dir_open("/sys/devices/system/cpu");
+    if (!dir) {
+        if (cpu->cores_logical == 0) cpu->cores_logical = get_nprocs_conf();
+        cpu->cores_physical = cpu->cores_logical;
+        return;
+    }
 
-    struct dirent* entry;
+    const char* name;
+    unsigned char type;
     int unique_cores[1024] = {0};
     int core_count = 0;
+    int logical = 0;
     
-    while ((entry = readdir(dir)) != NULL) {
-        if (entry->d_type != DT_DIR || !string_starts_with(entry->d_name, "cpu") || 
-            !char_is_digit(entry->d_name[3]))
+    while ((name = uf_dir_next(dir, &type)) != NULL) {
+        if (type != DT_DIR || !string_starts_with(name, "cpu") || 
+            !char_is_digit(name[3]))
             continue;
+        logical++;
 
-        char path[512];
-        snprintf(path, sizeof(path), "/sys/devices/system/cpu/%s/topology/core_id", entry->d_name);
-        
+        char path[128];
         char buffer[64];
-        if (read_file_buffer(path, buffer, sizeof(buffer))) {
-            int core_id = atoi(buffer);
+        int package_id = 0, cluster_id = 0;
+        snprintf(path, sizeof(path), "%s/topology/physical_package_id", name);
+        if (uf_read_value("/sys/devices/system/cpu", path, buffer, sizeof(buffer))) package_id = atoi(buffer);
+        snprintf(path, sizeof(path), "%s/topology/cluster_id", name);
+        if (uf_read_value("/sys/devices/system/cpu", path, buffer, sizeof(buffer)) && atoi(buffer) > 0) cluster_id = atoi(buffer);
+        
+        snprintf(path, sizeof(path), "%s/topology/core_id", name);
+        if (uf_read_value("/sys/devices/system/cpu", path, buffer, sizeof(buffer))) {
+            // core ids restart on every socket, and on arm64 in every cluster
+            int core_id = (package_id << 20) | ((cluster_id & 0xff) << 12) | (atoi(buffer) & 0xfff);
             int found = 0;
             for (int i = 0; i < core_count; i++) {
                 if (unique_cores[i] == core_id) {
@@ -415,58 +341,11 @@ static void detect_physical_cores(cpu_result_t* cpu) {
         }
     }
     
-    closedir(dir);
+    uf_dir_close(dir);
+    if (cpu->cores_logical == 0) cpu->cores_logical = logical;
     cpu->cores_physical = core_count > 0 ? core_count : cpu->cores_logical;
 }
 
-static int read_file_buffer(const char* path, char* buffer, size_t size) {
-    FILE* f = fopen(path, "r");
-    if (!f) return 0;
-    
-    size_t read = fread(buffer, 1, size - 1, f);
-    fclose(f);
-    
-    if (read > 0) {
-        buffer[read] = '\0';
-        trim_string(buffer);
-        return 1;
-    }
-    return 0;
-}
-
-static int read_file_buffer_relative(int dfd, const char* filename, char* buffer, size_t size) {
-    int fd = openat(dfd, filename, O_RDONLY);
-    if (fd < 0) return 0;
-    
-    ssize_t read_bytes = read(fd, buffer, size - 1);
-    close(fd);
-    
-    if (read_bytes > 0) {
-        buffer[read_bytes] = '\0';
-        trim_string(buffer);
-        return 1;
-    }
-    return 0;
-}
-
-static int parse_prop_line(const char* line, const char* key, char* output, size_t output_size) {
-    char search_key[128];
-    snprintf(search_key, sizeof(search_key), "%s\t:", key);
-    
-    if (!string_starts_with(line, search_key)) {
-        snprintf(search_key, sizeof(search_key), "%s :", key);
-        if (!string_starts_with(line, search_key))
-            return 0;
-    }
-    
-    const char* value = line + strlen(search_key);
-    while (*value == ' ' || *value == '\t') value++;
-    
-    snprintf(output, output_size, "%s", value);
-    trim_string(output);
-    return strlen(output) > 0;
-}
-
 static void trim_string(char* str) {
     if (!str) return;
     
@@ -502,34 +381,18 @@ static int string_contains(const char* haystack, const char* needle) {
 static int get_android_property(const char* prop, char* buffer, size_t size) {
     if (!UF_IS_ANDROID) return 0;
     
-    char cmd[256];
-    snprintf(cmd, sizeof(cmd), "getprop %s 2>/dev/null", prop);
-    
-    FILE* f = popen(cmd, "r");
-    if (!f) return 0;
-    
-    int success = 0;
-    if (fgets(buffer, size, f)) {
-        trim_string(buffer);
-        success = strlen(buffer) > 0;
-    }
-    pclose(f);
-    
-    return success;
+    return uf_prop_get(prop, buffer, size);
 }
 
 static uint32_t get_frequency_value(const char* base_path, const char* file1, const char* file2) {
-    char path[512];
     char buffer[64];
     
-    snprintf(path, sizeof(path), "%s%s", base_path, file1);
-    if (read_file_buffer(path, buffer, sizeof(buffer))) {
+    if (uf_read_value(base_path, file1, buffer, sizeof(buffer))) {
         return (uint32_t)(atoi(buffer) / 1000);
     }
     
     if (file2) {
-        snprintf(path, sizeof(path), "%s%s", base_path, file2);
-        if (read_file_buffer(path, buffer, sizeof(buffer))) {
+        if (uf_read_value(base_path, file2, buffer, sizeof(buffer))) {
             return (uint32_t)(atoi(buffer) / 1000);
         }
     }
@@ -541,87 +404,79 @@ static int char_is_digit(char c) {
     return c >= '0' && c <= '9';
 }
 
-void cpu_string(char* out, size_t n) {
+// Every field is always present; what could not be detected is NONE.
+static void fact_count(uf_fact_t* f, const char* key, int v) {
+    if (v > 0) uf_fact_int(f, key, UF_FACT_INT, v);
+    else uf_fact_none(f, key);
+}
+
+static void fact_mhz(uf_fact_t* f, const char* key, float v) {
+    if (v > 0) uf_fact_num(f, key, UF_FACT_MHZ, v);
+    else uf_fact_none(f, key);
+}
+
+static void text_append(char* out, size_t n, size_t* len, const char* fmt, ...) {
+    if (*len >= n) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int w = vsnprintf(out + *len, n - *len, fmt, ap);
+    va_end(ap);
+    if (w > 0) *len += (size_t)w;
+}
+
+void cpu_fact(uf_fact_t* f) {
     cpu_result_t cpu = {0};
     
     const char* error = cpu_detect_impl(&cpu);
     if (error || strlen(cpu.name) == 0) {
-        FILE* f = fopen("/proc/cpuinfo","r");
-        int cores = sysconf(_SC_NPROCESSORS_ONLN);
-        if(f){
-            char line[512], model[256]="";
-            while(fgets(line,sizeof(line),f)){
-                if(strncasecmp(line,"model name",10)==0 || strncasecmp(line,"Hardware",8)==0){
-                    char* p = strchr(line, ':'); 
-                    if(p){ 
-                        p++; 
-                        while(*p == ' ' || *p == '\t') p++;
-                        char* end = p + strlen(p) - 1;
-                        while(end >= p && (*end == '\n' || *end == '\r')) *end-- = '\0';
-                        snprintf(model,sizeof(model),"%s",p); 
-                        break; 
-                    }
-                }
-            }
-            fclose(f);
-            if(model[0]){ 
-                snprintf(out,n,"%s (%d cores)", model, cores>0?cores:0); 
-                return; 
-            }
+        const uf_cpuinfo_t* info = uf_cpuinfo();
+        const char* model = NULL;
+        char hw[128] = {0};
+        if (info) {
+            model = info->count ? info->procs[0].model_name : NULL;
+            if (!model) model = info->hardware;
         }
-        if(UF_IS_ANDROID){
-            char hw[128]={0};
-            FILE* pf = popen("getprop ro.hardware 2>/dev/null", "r");
-            if(pf) {
-                if(fgets(hw, sizeof(hw), pf)) {
-                    char* end = hw + strlen(hw) - 1;
-                    while(end >= hw && (*end == '\n' || *end == '\r')) *end-- = '\0';
-                }
-                pclose(pf);
-            }
-            snprintf(out,n,"%s (%d cores)", hw[0]?hw:"CPU", cores>0?cores:0);
-            return;
+        if (!model && UF_IS_ANDROID) {
+            uf_prop_get("ro.hardware", hw, sizeof(hw));
+            if (hw[0]) model = hw;
         }
-        snprintf(out,n,"CPU (%d cores)", cores>0?cores:0);
-        return;
-    }
-    
-    char temp_buf[1024] = {0};
-    
-    if (strlen(cpu.name) > 0) {
-        snprintf(temp_buf, sizeof(temp_buf), "%s", cpu.name);
-    } else {
-        strcpy(temp_buf, "Unknown CPU");
-    }
-    
-    char core_info[64];
-    if (cpu.cores_logical > cpu.cores_physical && cpu.cores_physical > 0) {
-        snprintf(core_info, sizeof(core_info), " (%dC/%dT)", cpu.cores_physical, cpu.cores_logical);
-    } else if (cpu.cores_physical > 0) {
-        snprintf(core_info, sizeof(core_info), " (%d cores)", cpu.cores_physical);
-    } else {
-        snprintf(core_info, sizeof(core_info), " (%d cores)", cpu.cores_logical);
-    }
-    strcat(temp_buf, core_info);
+        memset(&cpu, 0, sizeof(cpu));
+        snprintf(cpu.name, sizeof(cpu.name), "%s", model ? model : "CPU");
+        cpu.cores_logical = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    
+    uf_fact_str(f, "name", cpu.name);
+    uf_fact_str(f, "vendor", cpu.vendor);
+    fact_count(f, "cores_physical", cpu.cores_physical);
+    fact_count(f, "cores_logical", cpu.cores_logical);
+    fact_count(f, "cores_online", cpu.cores_online);
+    fact_mhz(f, "frequency_base", cpu.frequency_base);
+    fact_mhz(f, "frequency_max", cpu.frequency_max);
+}
+
+void cpu_text(const uf_fact_t* f, char* out, size_t n) {
+    const char* name = uf_fact_get_str(f, "name");
+    long long physical = uf_fact_get_int(f, "cores_physical", 0);
+    long long logical = uf_fact_get_int(f, "cores_logical", 0);
     
-    snprintf(out, n, "%s", temp_buf);
+    if (!name) name = "Unknown CPU";
+    if (logical > physical && physical > 0)
+        snprintf(out, n, "%s (%lldC/%lldT)", name, physical, logical);
+    else
+        snprintf(out, n, "%s (%lld cores)", name, physical > 0 ? physical : logical);
 }
 
 const char* cpu_detect_impl(cpu_result_t* cpu) {
-    cpu->temperature = detect_cpu_temp();
-    cpu->cores_logical = get_nprocs_conf();
-    cpu->cores_online = get_nprocs();
+    // counted by the topology walk in detect_physical_cores, which (unlike
+    // get_nprocs_conf) goes through the sysroot/snapshot layer
+    cpu->cores_logical = 0;
 
     detect_architecture(cpu);
     detect_android(cpu);
     detect_frequency(cpu);
 
     if (strlen(cpu->name) == 0) {
-        char cpuinfo_content[8192];
-        if (!read_file_buffer(FF_CPUINFO_PATH, cpuinfo_content, sizeof(cpuinfo_content)))
-            return "Failed to read /proc/cpuinfo";
-
-        const char* error = parse_cpu_info(cpuinfo_content, cpu);
+        const char* error = parse_cpu_info(cpu);
         if (error) return error;
     }
 
@@ -631,106 +486,48 @@ const char* cpu_detect_impl(cpu_result_t* cpu) {
 
     if (cpu->cores_physical == 0)
         detect_physical_cores(cpu);
+    detect_online_cores(cpu);
 
     return NULL;
 }
 
-void cpu_info_detailed(char* out, size_t n) {
-    cpu_result_t cpu = {0};
-    
-    const char* error = cpu_detect_impl(&cpu);
-    if (error) {
-        snprintf(out, n, "Error: %s", error);
-        return;
-    }
-
-    char temp_buf[2048] = {0};
-    
-    if (strlen(cpu.name) > 0) {
-        snprintf(temp_buf, sizeof(temp_buf), "%s", cpu.name);
-    } else {
-        strcpy(temp_buf, "Unknown CPU");
-    }
-    
-    if (strlen(cpu.vendor) > 0 && !string_equals(cpu.vendor, "unknown")) {
-        char vendor_info[128];
-        snprintf(vendor_info, sizeof(vendor_info), " (%s)", cpu.vendor);
-        strcat(temp_buf, vendor_info);
-    }
-    
-    char core_info[128];
-    if (cpu.cores_logical > cpu.cores_physical) {
-        snprintf(core_info, sizeof(core_info), " | %dC/%dT", cpu.cores_physical, cpu.cores_logical);
-    } else {
-        snprintf(core_info, sizeof(core_info), " | %d cores", cpu.cores_physical);
-    }
-    strcat(temp_buf, core_info);
-    
-    if (cpu.frequency_base > 0 || cpu.frequency_max > 0) {
-        char freq_info[128];
-        if (cpu.frequency_base > 0 && cpu.frequency_max > 0 && cpu.frequency_base != cpu.frequency_max) {
-            snprintf(freq_info, sizeof(freq_info), " | %.1f-%.1f GHz", 
-                    cpu.frequency_base / 1000.0f, cpu.frequency_max / 1000.0f);
-        } else if (cpu.frequency_max > 0) {
-            snprintf(freq_info, sizeof(freq_info), " | %.1f GHz", cpu.frequency_max / 1000.0f);
-        } else if (cpu.frequency_base > 0) {
-            snprintf(freq_info, sizeof(freq_info), " | %.1f GHz", cpu.frequency_base / 1000.0f);
-        }
-        strcat(temp_buf, freq_info);
-    }
-    
-    if (cpu.temperature > 0) {
-        char temp_info[32];
-        snprintf(temp_info, sizeof(temp_info), " | %.1f°C", cpu.temperature);
-        strcat(temp_buf, temp_info);
-    }
-    
-    if (strlen(cpu.governor) > 0) {
-        char gov_info[32];
-        snprintf(gov_info, sizeof(gov_info), " | %s", cpu.governor);
-        strcat(temp_buf, gov_info);
-    }
-    
-    snprintf(out, n, "%s", temp_buf);
-}
-
-void cpu_performance_info(char* out, size_t n) {
+void cpu_perf_fact(uf_fact_t* f) {
     cpu_result_t cpu = {0};
     
     cpu.temperature = detect_cpu_temp();
     detect_frequency(&cpu);
     
-    char temp_buf[512] = {0};
-    
-    if (cpu.frequency_base > 0 || cpu.frequency_max > 0) {
-        char freq_str[128];
-        if (cpu.frequency_base > 0 && cpu.frequency_max > 0) {
-            snprintf(freq_str, sizeof(freq_str), "Freq: %.1f-%.1f GHz", 
-                    cpu.frequency_base / 1000.0f, cpu.frequency_max / 1000.0f);
-        } else if (cpu.frequency_max > 0) {
-            snprintf(freq_str, sizeof(freq_str), "Max Freq: %.1f GHz", cpu.frequency_max / 1000.0f);
-        } else {
-            snprintf(freq_str, sizeof(freq_str), "Base Freq: %.1f GHz", cpu.frequency_base / 1000.0f);
-        }
-        strcpy(temp_buf, freq_str);
-    }
-    
-    if (cpu.temperature > 0) {
-        char temp_str[64];
-        snprintf(temp_str, sizeof(temp_str), "%sTemp: %.1f°C", 
-                strlen(temp_buf) > 0 ? " | " : "", cpu.temperature);
-        strcat(temp_buf, temp_str);
-    }
-    
-    char governor[64] = {0};
-    if (read_file_buffer("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor", governor, sizeof(governor))) {
-        char gov_str[96];
-        snprintf(gov_str, sizeof(gov_str), "%sGovernor: %s", 
-                strlen(temp_buf) > 0 ? " | " : "", governor);
-        strcat(temp_buf, gov_str);
-    }
-    
-    snprintf(out, n, "%s", strlen(temp_buf) > 0 ? temp_buf : "Performance info unavailable");
+    fact_mhz(f, "frequency_current", cpu.frequency_current);
+    fact_mhz(f, "frequency_base", cpu.frequency_base);
+    fact_mhz(f, "frequency_max", cpu.frequency_max);
+    if (cpu.temperature > 0) uf_fact_num(f, "temperature", UF_FACT_CELSIUS, cpu.temperature);
+    else uf_fact_none(f, "temperature");
+    uf_fact_str(f, "governor", cpu.governor);
+}
+
+void cpu_perf_text(const uf_fact_t* f, char* out, size_t n) {
+    double cur = uf_fact_get_num(f, "frequency_current", 0);
+    double base = uf_fact_get_num(f, "frequency_base", 0);
+    double max = uf_fact_get_num(f, "frequency_max", 0);
+    double temp = uf_fact_get_num(f, "temperature", 0);
+    const char* governor = uf_fact_get_str(f, "governor");
+    size_t len = 0;
+    
+    out[0] = '\0';
+    if (cur > 0) text_append(out, n, &len, "Cur: %.2f GHz", cur / 1000.0);
+    if (base > 0 || max > 0) {
+        const char* sep = len > 0 ? " | " : "";
+        if (base > 0 && max > 0)
+            text_append(out, n, &len, "%sFreq: %.1f-%.1f GHz", sep, base / 1000.0, max / 1000.0);
+        else if (max > 0)
+            text_append(out, n, &len, "%sMax Freq: %.1f GHz", sep, max / 1000.0);
+        else
+            text_append(out, n, &len, "%sBase Freq: %.1f GHz", sep, base / 1000.0);
+    }
+    if (temp > 0) text_append(out, n, &len, "%sTemp: %.1f°C", len > 0 ? " | " : "", temp);
+    if (governor) text_append(out, n, &len, "%sGovernor: %s", len > 0 ? " | " : "", governor);
+    
+    if (len == 0) snprintf(out, n, "Performance info unavailable");
 }
 
 void cpu_soc_info(char* out, size_t n) {
@@ -744,10 +541,7 @@ void cpu_soc_info(char* out, size_t n) {
     detect_architecture(&cpu);
     
     if (strlen(cpu.name) == 0) {
-        char cpuinfo_content[8192];
-        if (read_file_buffer(FF_CPUINFO_PATH, cpuinfo_content, sizeof(cpuinfo_content))) {
-            parse_cpu_info(cpuinfo_content, &cpu);
-        }
+        parse_cpu_info(&cpu);
     }
     
     if (string_equals(cpu.arch, "aarch64") || string_equals(cpu.arch, "armv7")) {
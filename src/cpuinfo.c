@@ -0,0 +1,96 @@
+// src/cpuinfo.c — one-shot /proc/cpuinfo index
+#include "common.h"
+#include "cpuinfo.h"
+#include "trace.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <pthread.h>
+
+static pthread_once_t ci_once = PTHREAD_ONCE_INIT;
+static uf_cpuinfo_t ci;
+static int ci_ok;
+
+static char* strip(char* s, char* end){
+    while(s < end && isspace((unsigned char)*s)) s++;
+    while(end > s && isspace((unsigned char)end[-1])) end--;
+    *end = 0;
+    return s;
+}
+
+// first occurrence wins, like the line scanners this replaces
+static void set_once(const char** field, const char* value){
+    if(!*field && *value) *field = value;
+}
+
+static void assign(uf_cpuinfo_proc_t* r, const char* key, const char* value){
+    if(!strcmp(key, "model name") || !strcmp(key, "Model Name") ||
+       !strcmp(key, "cpu model") || !strcmp(key, "cpu"))
+        set_once(&r->model_name, value);
+    else if(!strcmp(key, "vendor_id") || !strcmp(key, "vendor"))
+        set_once(&r->vendor, value);
+    else if(!strcmp(key, "cpu MHz") || !strcmp(key, "CPU MHz") || !strcmp(key, "clock")){
+        if(r->mhz == 0) r->mhz = atof(value);
+    }
+    else if(!strcmp(key, "flags") || !strcmp(key, "Features"))
+        set_once(&r->flags, value);
+    else if(!strcmp(key, "CPU part"))
+        set_once(&r->cpu_part, value);
+    else if(!strcmp(key, "CPU implementer"))
+        set_once(&r->cpu_implementer, value);
+}
+
+static void build(void){
+    UF_TRACE_BEGIN("cpuinfo");
+    size_t len = 0;
+    // kept for the life of the process: the index points into it
+    char* text = uf_read_file_alloc("/proc/cpuinfo", &len);
+    if(!text){ UF_TRACE_END(); return; }
+
+    uf_cpuinfo_proc_t* procs = NULL;
+    size_t count = 0, cap = 0;
+    uf_cpuinfo_proc_t* cur = NULL;
+    ci.common.processor = -1;
+
+    char* line = text;
+    char* end = text + len;
+    while(line < end){
+        char* eol = memchr(line, '\n', (size_t)(end - line));
+        if(!eol) eol = end;
+        char* colon = memchr(line, ':', (size_t)(eol - line));
+        if(!colon){
+            // a blank line closes the processor block
+            if(*strip(line, eol) == 0) cur = NULL;
+            line = eol < end ? eol + 1 : end;
+            continue;
+        }
+        char* key = strip(line, colon);
+        char* value = strip(colon + 1, eol);
+
+        if(!strcmp(key, "processor")){
+            if(count == cap){
+                size_t grown_cap = cap ? cap * 2 : 16;
+                uf_cpuinfo_proc_t* grown = realloc(procs, grown_cap * sizeof(*grown));
+                if(!grown) break;
+                procs = grown;
+                cap = grown_cap;
+            }
+            cur = &procs[count++];
+            memset(cur, 0, sizeof(*cur));
+            cur->processor = atoi(value);
+        }
+        else if(!strcmp(key, "Hardware")) set_once(&ci.hardware, value);
+        else assign(cur ? cur : &ci.common, key, value);
+        line = eol < end ? eol + 1 : end;
+    }
+
+    ci.procs = procs;
+    ci.count = count;
+    ci_ok = 1;
+    UF_TRACE_END();
+}
+
+const uf_cpuinfo_t* uf_cpuinfo(void){
+    pthread_once(&ci_once, build);
+    return ci_ok ? &ci : NULL;
+}
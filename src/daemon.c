@@ -0,0 +1,242 @@
+// src/daemon.c — background collector serving snapshots over AF_UNIX
+#include "common.h"
+#include "daemon.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/signalfd.h>
+
+#define DAEMON_MAX_CLIENTS 64
+#define CLIENT_TIMEOUT_MS 500
+
+typedef struct {
+    int fd;
+    size_t sent;
+    size_t len;
+    char data[UF_SNAPSHOT_MAX];
+} daemon_client_t;
+
+void uf_daemon_socket_path(char* out, size_t n){
+    const char* run = getenv("XDG_RUNTIME_DIR");
+    if(run && *run){
+        snprintf(out, n, "%s/xfetch.sock", run);
+        return;
+    }
+    // /tmp is shared: the socket goes in a directory only we can enter,
+    // and one somebody else made first is not used at all
+    char dir[64];
+    struct stat st;
+    snprintf(dir, sizeof(dir), "/tmp/xfetch-%ld", (long)getuid());
+    mkdir(dir, 0700);
+    if(lstat(dir, &st) != 0 || !S_ISDIR(st.st_mode) || st.st_uid != getuid() || (st.st_mode & 077)){
+        out[0] = 0;
+        return;
+    }
+    snprintf(out, n, "%s/xfetch.sock", dir);
+}
+
+static int fill_addr(struct sockaddr_un* addr, const char* path){
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if(!path[0] || strlen(path) >= sizeof(addr->sun_path)) return -1;
+    snprintf(addr->sun_path, sizeof(addr->sun_path), "%s", path);
+    return 0;
+}
+
+static int daemon_listen(const char* path){
+    struct sockaddr_un addr;
+    if(fill_addr(&addr, path) != 0) return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(fd < 0) return -1;
+
+    if(bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0){
+        if(errno != EADDRINUSE){ close(fd); return -1; }
+        // a live daemon answers; a stale socket file refuses the connection
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int alive = probe >= 0 && connect(probe, (struct sockaddr*)&addr, sizeof(addr)) == 0;
+        if(probe >= 0) close(probe);
+        if(alive){
+            close(fd);
+            errno = EADDRINUSE;
+            return -1;
+        }
+        unlink(path);
+        if(bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0){ close(fd); return -1; }
+    }
+    if(listen(fd, 128) != 0){ close(fd); unlink(path); return -1; }
+    return fd;
+}
+
+static void client_drop(int ep, daemon_client_t** slot){
+    epoll_ctl(ep, EPOLL_CTL_DEL, (*slot)->fd, NULL);
+    close((*slot)->fd);
+    free(*slot);
+    *slot = NULL;
+}
+
+// Write as much as the socket takes; returns 1 once the snapshot is out.
+static int client_flush(daemon_client_t* c){
+    while(c->sent < c->len){
+        ssize_t w = write(c->fd, c->data + c->sent, c->len - c->sent);
+        if(w > 0){ c->sent += (size_t)w; continue; }
+        if(w < 0 && errno == EINTR) continue;
+        if(w < 0 && errno == EAGAIN) return 0;
+        return 1;   // peer went away, nothing left to do
+    }
+    return 1;
+}
+
+static void daemon_accept(int ep, int lfd, daemon_client_t** clients, const char* snap, size_t snap_len){
+    for(;;){
+        int fd = accept4(lfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(fd < 0) return;
+
+        int slot = -1;
+        for(int i=0;i<DAEMON_MAX_CLIENTS;i++){ if(!clients[i]){ slot = i; break; } }
+        daemon_client_t* c = slot >= 0 ? malloc(sizeof(*c)) : NULL;
+        if(!c){ close(fd); continue; }
+
+        c->fd = fd;
+        c->sent = 0;
+        c->len = snap_len;
+        memcpy(c->data, snap, snap_len);
+        if(client_flush(c)){ close(fd); free(c); continue; }
+
+        // snapshot did not fit in the socket buffer, finish it on EPOLLOUT
+        struct epoll_event ev = { .events = EPOLLOUT, .data.u32 = (uint32_t)slot + 3 };
+        if(epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev) != 0){ close(fd); free(c); continue; }
+        clients[slot] = c;
+    }
+}
+
+int uf_daemon_run(const char* path, int interval_ms, int jobs, int use_cache){
+    if(interval_ms <= 0) interval_ms = 1000;
+    if(!path[0]){
+        fprintf(stderr, "ultrafetch: /tmp/xfetch-%ld is not a private directory; pass --socket\n", (long)getuid());
+        return -1;
+    }
+
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigprocmask(SIG_BLOCK, &mask, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    int lfd = daemon_listen(path);
+    if(lfd < 0){
+        fprintf(stderr, "ultrafetch: cannot listen on %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    int sfd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    int ep = epoll_create1(EPOLL_CLOEXEC);
+    if(sfd < 0 || tfd < 0 || ep < 0){
+        close(lfd); unlink(path);
+        return -1;
+    }
+
+    struct itimerspec its = {
+        .it_interval = { interval_ms / 1000, (long)(interval_ms % 1000) * 1000000L },
+        .it_value    = { interval_ms / 1000, (long)(interval_ms % 1000) * 1000000L },
+    };
+    timerfd_settime(tfd, 0, &its, NULL);
+
+    struct epoll_event ev = { .events = EPOLLIN };
+    ev.data.u32 = 0; epoll_ctl(ep, EPOLL_CTL_ADD, lfd, &ev);
+    ev.data.u32 = 1; epoll_ctl(ep, EPOLL_CTL_ADD, tfd, &ev);
+    ev.data.u32 = 2; epoll_ctl(ep, EPOLL_CTL_ADD, sfd, &ev);
+
+    static uf_registry_t reg;
+    static char snap[UF_SNAPSHOT_MAX];
+    // $SHELL, $TERM and the terminal font are the client's, not ours
+    int all[UF_MOD_COUNT];
+    size_t count = 0;
+    for(int i=0;i<UF_MOD_COUNT;i++){
+        if(!(uf_modules[i].flags & UF_MOD_ENV)) all[count++] = i;
+    }
+
+    uf_registry_init(&reg, use_cache);
+    uf_registry_collect(&reg, all, count, jobs);
+    uf_registry_finish(&reg);
+    size_t snap_len = uf_registry_dump(&reg, snap, sizeof(snap));
+
+    daemon_client_t* clients[DAEMON_MAX_CLIENTS] = {0};
+    int running = 1;
+    while(running){
+        struct epoll_event events[16];
+        int nev = epoll_wait(ep, events, 16, -1);
+        if(nev < 0){
+            if(errno == EINTR) continue;
+            break;
+        }
+        for(int i=0;i<nev;i++){
+            uint32_t tag = events[i].data.u32;
+            if(tag == 0){
+                daemon_accept(ep, lfd, clients, snap, snap_len);
+            } else if(tag == 1){
+                uint64_t ticks;
+                if(read(tfd, &ticks, sizeof(ticks)) != sizeof(ticks)) continue;
+                // static facts were collected once; only volatile ones move
+                uf_registry_invalidate_volatile(&reg);
+                uf_registry_collect(&reg, all, count, jobs);
+                snap_len = uf_registry_dump(&reg, snap, sizeof(snap));
+            } else if(tag == 2){
+                running = 0;
+            } else {
+                daemon_client_t** slot = &clients[tag - 3];
+                if(*slot && (client_flush(*slot) || (events[i].events & (EPOLLERR | EPOLLHUP))))
+                    client_drop(ep, slot);
+            }
+        }
+    }
+
+    for(int i=0;i<DAEMON_MAX_CLIENTS;i++){ if(clients[i]) client_drop(ep, &clients[i]); }
+    close(ep); close(tfd); close(sfd); close(lfd);
+    unlink(path);
+    return 0;
+}
+
+int uf_client_fetch(const char* path, uf_registry_t* reg){
+    struct sockaddr_un addr;
+    if(fill_addr(&addr, path) != 0) return 0;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(fd < 0) return 0;
+    if(connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0){ close(fd); return 0; }
+    // the snapshot is printed as is: only our own daemon may supply it
+    struct ucred peer;
+    socklen_t peer_len = sizeof(peer);
+    if(getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &peer, &peer_len) != 0 || peer.uid != getuid()){
+        close(fd);
+        return 0;
+    }
+
+    char snap[UF_SNAPSHOT_MAX];
+    size_t len = 0;
+    long long deadline = uf_now_ms() + CLIENT_TIMEOUT_MS;
+    for(;;){
+        int left = (int)(deadline - uf_now_ms());
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        if(left <= 0 || poll(&pfd, 1, left) <= 0){ close(fd); return 0; }
+        ssize_t r = read(fd, snap + len, sizeof(snap) - 1 - len);
+        if(r < 0 && errno == EINTR) continue;
+        if(r <= 0) break;
+        len += (size_t)r;
+        if(len >= sizeof(snap) - 1) break;
+    }
+    close(fd);
+    snap[len] = 0;
+    return uf_registry_load(reg, snap) > 0;
+}
@@ -0,0 +1,106 @@
+// src/elfscan.c — version strings from an executable's read-only data
+#include "common.h"
+#include "elfscan.h"
+#include <elf.h>
+#include <stdint.h>
+#include <string.h>
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define HOST_ELFDATA ELFDATA2LSB
+#else
+#define HOST_ELFDATA ELFDATA2MSB
+#endif
+
+#define MAX_SPANS 8
+
+typedef struct {
+    size_t off, len;
+} span_t;
+
+// Headers are copied out: a snapshot archive gives no alignment guarantee.
+#define DEFINE_SPANS(bits)                                                            \
+static size_t spans##bits(const unsigned char* img, size_t size, span_t* out){        \
+    Elf##bits##_Ehdr eh;                                                              \
+    if(size < sizeof(eh)) return 0;                                                   \
+    memcpy(&eh, img, sizeof(eh));                                                     \
+                                                                                      \
+    if(eh.e_shoff && eh.e_shentsize == sizeof(Elf##bits##_Shdr) &&                    \
+       eh.e_shstrndx < eh.e_shnum && eh.e_shoff < size &&                             \
+       (size - eh.e_shoff) / sizeof(Elf##bits##_Shdr) >= eh.e_shnum){                 \
+        Elf##bits##_Shdr names;                                                       \
+        memcpy(&names, img + eh.e_shoff + eh.e_shstrndx * sizeof(names), sizeof(names)); \
+        for(size_t i = 0; names.sh_offset < size && i < eh.e_shnum; i++){             \
+            Elf##bits##_Shdr sh;                                                      \
+            memcpy(&sh, img + eh.e_shoff + i * sizeof(sh), sizeof(sh));               \
+            if(sh.sh_type != SHT_PROGBITS || sh.sh_name >= names.sh_size) continue;   \
+            if(names.sh_offset + sh.sh_name + sizeof(".rodata") > size) continue;     \
+            if(memcmp(img + names.sh_offset + sh.sh_name, ".rodata", sizeof(".rodata")) != 0) continue; \
+            if(sh.sh_offset >= size || sh.sh_size > size - sh.sh_offset) return 0;    \
+            out[0].off = sh.sh_offset;                                                \
+            out[0].len = sh.sh_size;                                                  \
+            return 1;                                                                 \
+        }                                                                             \
+    }                                                                                 \
+                                                                                      \
+    size_t count = 0;                                                                 \
+    if(eh.e_phentsize != sizeof(Elf##bits##_Phdr) || eh.e_phoff >= size ||            \
+       (size - eh.e_phoff) / sizeof(Elf##bits##_Phdr) < eh.e_phnum) return 0;         \
+    for(size_t i = 0; i < eh.e_phnum && count < MAX_SPANS; i++){                      \
+        Elf##bits##_Phdr ph;                                                          \
+        memcpy(&ph, img + eh.e_phoff + i * sizeof(ph), sizeof(ph));                   \
+        if(ph.p_type != PT_LOAD || (ph.p_flags & (PF_W | PF_X)) || !(ph.p_flags & PF_R)) continue; \
+        if(ph.p_offset >= size || ph.p_filesz > size - ph.p_offset) continue;         \
+        out[count].off = ph.p_offset;                                                 \
+        out[count].len = ph.p_filesz;                                                 \
+        count++;                                                                      \
+    }                                                                                 \
+    return count;                                                                     \
+}
+
+DEFINE_SPANS(64)
+DEFINE_SPANS(32)
+
+static int is_digit(unsigned char c){
+    return c >= '0' && c <= '9';
+}
+
+static int search(const unsigned char* p, size_t len, const char* needle, char* out, size_t n){
+    size_t nlen = strlen(needle);
+    const unsigned char* end = p + len;
+    while(p < end){
+        const unsigned char* hit = memmem(p, (size_t)(end - p), needle, nlen);
+        if(!hit) return 0;
+        const unsigned char* v = hit + nlen;
+        p = hit + 1;
+        if(v >= end || !is_digit(*v)) continue;
+
+        size_t k = 0;
+        while(v + k < end && (is_digit(v[k]) || v[k] == '.')) k++;
+        if(v[k - 1] == '.') k--;
+        if(k >= n) continue;
+        memcpy(out, v, k);
+        out[k] = 0;
+        return 1;
+    }
+    return 0;
+}
+
+int uf_elf_version(const char* path, const char* needle, char* out, size_t n){
+    if(!path || !needle || !*needle || !out || n == 0) return 0;
+    size_t size;
+    const unsigned char* img = (const unsigned char*)uf_map_file(path, &size);
+    if(!img) return 0;
+
+    span_t spans[MAX_SPANS];
+    size_t count = 0;
+    if(size > EI_NIDENT && memcmp(img, ELFMAG, SELFMAG) == 0 && img[EI_DATA] == HOST_ELFDATA){
+        if(img[EI_CLASS] == ELFCLASS64) count = spans64(img, size, spans);
+        else if(img[EI_CLASS] == ELFCLASS32) count = spans32(img, size, spans);
+    }
+
+    int found = 0;
+    for(size_t i = 0; i < count && !found; i++)
+        found = search(img + spans[i].off, spans[i].len, needle, out, n);
+    uf_unmap_file(img, size);
+    return found;
+}
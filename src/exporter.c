@@ -0,0 +1,409 @@
+// src/exporter.c — Prometheus metrics over HTTP or into a textfile
+#include "common.h"
+#include "exporter.h"
+#include "module.h"
+#include "frame.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <math.h>
+#include <signal.h>
+#include <time.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/signalfd.h>
+
+#define EXPORTER_MAX_CLIENTS 64
+#define EXPORTER_REQUEST_MAX 2048
+#define EXPORTER_CLIENT_TIMEOUT_MS 5000
+#define EXPORTER_CONTENT_TYPE "text/plain; version=0.0.4; charset=utf-8"
+
+static const int static_ids[] = { UF_MOD_OS, UF_MOD_HOST, UF_MOD_KERNEL, UF_MOD_ARCH, UF_MOD_CPU, UF_MOD_GPU };
+static const int live_ids[] = { UF_MOD_UPTIME, UF_MOD_PERF, UF_MOD_RAM, UF_MOD_SWAP };
+#define STATIC_COUNT (sizeof(static_ids) / sizeof(static_ids[0]))
+#define LIVE_COUNT (sizeof(live_ids) / sizeof(live_ids[0]))
+
+typedef struct {
+    int module;
+    const char* key;
+    const char* name;
+    const char* help;
+    double scale;   // fact unit to the metric's base unit
+} gauge_t;
+
+static const gauge_t static_gauges[] = {
+    { UF_MOD_CPU,  "cores_physical", "xfetch_cpu_physical_cores", "Physical CPU cores.", 1 },
+    { UF_MOD_CPU,  "cores_logical",  "xfetch_cpu_logical_cores",  "Logical CPUs (hardware threads).", 1 },
+    { UF_MOD_CPU,  "frequency_base", "xfetch_cpu_frequency_base_hertz", "Base CPU clock.", 1e6 },
+    { UF_MOD_CPU,  "frequency_max",  "xfetch_cpu_frequency_max_hertz",  "Maximum CPU clock.", 1e6 },
+    { UF_MOD_GPU,  "memory",         "xfetch_gpu_memory_bytes",   "Dedicated GPU memory.", 1 },
+};
+
+static const gauge_t live_gauges[] = {
+    { UF_MOD_RAM,    "total",             "xfetch_memory_total_bytes",      "Usable RAM.", 1 },
+    { UF_MOD_RAM,    "used",              "xfetch_memory_used_bytes",       "RAM in use.", 1 },
+    { UF_MOD_RAM,    "available",         "xfetch_memory_available_bytes",  "RAM available without swapping.", 1 },
+    { UF_MOD_RAM,    "cached",            "xfetch_memory_cached_bytes",     "Page cache.", 1 },
+    { UF_MOD_RAM,    "buffers",           "xfetch_memory_buffers_bytes",    "Block device buffers.", 1 },
+    { UF_MOD_SWAP,   "total",             "xfetch_swap_total_bytes",        "Swap space.", 1 },
+    { UF_MOD_SWAP,   "used",              "xfetch_swap_used_bytes",         "Swap in use.", 1 },
+    { UF_MOD_PERF,   "temperature",       "xfetch_cpu_temperature_celsius", "CPU package temperature.", 1 },
+    { UF_MOD_PERF,   "frequency_current", "xfetch_cpu_frequency_hertz",     "Current CPU clock.", 1e6 },
+    { UF_MOD_UPTIME, "seconds",           "xfetch_uptime_seconds",          "Time since boot.", 1 },
+};
+
+typedef struct {
+    uf_registry_t reg;
+    uf_frame_t head;     // info metrics and static gauges, rendered once
+    uf_frame_t body;     // head plus the latest volatile sample
+    long long sampled_ms;
+    int min_interval_ms;
+    int jobs;
+} exporter_t;
+
+static exporter_t exp_state;
+
+// Label values escape backslash, double quote and newline.
+static void put_label(uf_frame_t* f, const char* key, const char* value, int first){
+    uf_frame_printf(f, "%s%s=\"", first ? "" : ",", key);
+    for(const char* p = value ? value : ""; *p; p++){
+        if(*p == '\\') uf_frame_puts(f, "\\\\");
+        else if(*p == '"') uf_frame_puts(f, "\\\"");
+        else if(*p == '\n') uf_frame_puts(f, "\\n");
+        else uf_frame_put(f, p, 1);
+    }
+    uf_frame_put(f, "\"", 1);
+}
+
+// name{k="v",...} 1 from a NULL terminated key/value list.
+static void put_info(uf_frame_t* f, const char* name, const char* help, const char* const* labels){
+    uf_frame_printf(f, "# HELP %s %s\n# TYPE %s gauge\n%s{", name, help, name, name);
+    for(int i = 0; labels[i]; i += 2) put_label(f, labels[i], labels[i + 1], i == 0);
+    uf_frame_puts(f, "} 1\n");
+}
+
+static void put_gauges(uf_frame_t* f, uf_registry_t* reg, const gauge_t* g, size_t count){
+    for(size_t i = 0; i < count; i++){
+        double v = uf_fact_get_num(uf_registry_fact(reg, g[i].module), g[i].key, NAN);
+        if(!isfinite(v)) continue;   // not detected here: no sample at all
+        uf_frame_printf(f, "# HELP %s %s\n# TYPE %s gauge\n%s %.15g\n",
+                        g[i].name, g[i].help, g[i].name, g[i].name, v * g[i].scale);
+    }
+}
+
+static void render_head(exporter_t* e){
+    uf_registry_t* reg = &e->reg;
+    const uf_fact_t* host = uf_registry_fact(reg, UF_MOD_HOST);
+    const uf_fact_t* cpu = uf_registry_fact(reg, UF_MOD_CPU);
+    const uf_fact_t* gpu = uf_registry_fact(reg, UF_MOD_GPU);
+
+    uf_frame_init(&e->head, -1);
+    const char* const os[] = {
+        "name", uf_registry_value(reg, UF_MOD_OS),
+        "kernel", uf_registry_value(reg, UF_MOD_KERNEL),
+        "arch", uf_registry_value(reg, UF_MOD_ARCH), NULL };
+    put_info(&e->head, "xfetch_os_info", "Operating system, kernel and architecture.", os);
+    const char* const hw[] = {
+        "name", uf_fact_get_str(host, "name"),
+        "vendor", uf_fact_get_str(host, "vendor"),
+        "family", uf_fact_get_str(host, "family"),
+        "sku", uf_fact_get_str(host, "sku"), NULL };
+    put_info(&e->head, "xfetch_host_info", "Machine model.", hw);
+    const char* const cpu_labels[] = {
+        "name", uf_fact_get_str(cpu, "name"),
+        "vendor", uf_fact_get_str(cpu, "vendor"), NULL };
+    put_info(&e->head, "xfetch_cpu_info", "CPU model.", cpu_labels);
+    const char* const gpu_labels[] = {
+        "name", uf_fact_get_str(gpu, "name"),
+        "vendor", uf_fact_get_str(gpu, "vendor"),
+        "driver", uf_fact_get_str(gpu, "driver"), NULL };
+    put_info(&e->head, "xfetch_gpu_info", "Primary GPU.", gpu_labels);
+    put_gauges(&e->head, reg, static_gauges, sizeof(static_gauges) / sizeof(static_gauges[0]));
+}
+
+static void exporter_init(exporter_t* e, int min_interval_ms, int jobs, int use_cache){
+    e->min_interval_ms = min_interval_ms;
+    e->jobs = jobs;
+    e->sampled_ms = 0;
+    uf_registry_init(&e->reg, use_cache);
+    uf_registry_collect(&e->reg, static_ids, STATIC_COUNT, jobs);
+    uf_registry_finish(&e->reg);
+    render_head(e);
+    // everything boot-stable is in hand; from here on a probe never forks
+    UF_ALLOW_SPAWN = 0;
+}
+
+// Re-sample the volatile modules unless the last sample is recent enough;
+// scrapes arriving closer together than min_interval_ms share one.
+static void exporter_sample(exporter_t* e){
+    long long now = uf_now_ms();
+    if(e->sampled_ms && now - e->sampled_ms < e->min_interval_ms) return;
+    e->sampled_ms = now;
+
+    uf_registry_invalidate_volatile(&e->reg);
+    uf_registry_collect(&e->reg, live_ids, LIVE_COUNT, e->jobs);
+    uf_frame_init(&e->body, -1);
+    uf_frame_put(&e->body, e->head.buf, e->head.len);
+    put_gauges(&e->body, &e->reg, live_gauges, sizeof(live_gauges) / sizeof(live_gauges[0]));
+}
+
+static void block_signals(sigset_t* mask){
+    sigemptyset(mask);
+    sigaddset(mask, SIGINT);
+    sigaddset(mask, SIGTERM);
+    sigprocmask(SIG_BLOCK, mask, NULL);
+    signal(SIGPIPE, SIG_IGN);
+}
+
+static int write_textfile(exporter_t* e, const char* path){
+    char tmp[4096];
+    if(snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp)){ errno = ENAMETOOLONG; return -1; }
+    exporter_sample(e);
+
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(fd < 0) return -1;
+    size_t off = 0;
+    while(off < e->body.len){
+        ssize_t w = write(fd, e->body.buf + off, e->body.len - off);
+        if(w < 0 && errno == EINTR) continue;
+        if(w <= 0){ close(fd); unlink(tmp); return -1; }
+        off += (size_t)w;
+    }
+    // node_exporter must never read a half-written file
+    if(close(fd) != 0 || rename(tmp, path) != 0){ unlink(tmp); return -1; }
+    return 0;
+}
+
+int uf_exporter_textfile(const char* path, int interval_ms, int jobs, int use_cache){
+    sigset_t mask;
+    block_signals(&mask);
+
+    exporter_t* e = &exp_state;
+    exporter_init(e, 0, jobs, use_cache);
+    for(;;){
+        if(write_textfile(e, path) != 0){
+            fprintf(stderr, "ultrafetch: cannot write %s: %s\n", path, strerror(errno));
+            return -1;
+        }
+        if(interval_ms <= 0) return 0;
+        struct timespec ts = { interval_ms / 1000, (long)(interval_ms % 1000) * 1000000L };
+        int sig = sigtimedwait(&mask, NULL, &ts);
+        if(sig > 0) return 0;
+    }
+}
+
+typedef struct {
+    int fd;
+    long long deadline;
+    size_t req_len;
+    char req[EXPORTER_REQUEST_MAX];
+    size_t sent;
+    size_t len;
+    char* data;    // response, NULL until the request is complete
+} exporter_client_t;
+
+// "host:port", "[v6]:port" or ":port"; the host must be numeric so that
+// starting up never waits on a resolver.
+static int exporter_listen(const char* spec){
+    char host[256];
+    const char* colon = strrchr(spec, ':');
+    if(!colon || !colon[1]){ errno = EINVAL; return -1; }
+    size_t hlen = (size_t)(colon - spec);
+    if(hlen >= 2 && spec[0] == '[' && spec[hlen - 1] == ']'){ spec++; hlen -= 2; }
+    if(hlen >= sizeof(host)){ errno = EINVAL; return -1; }
+    memcpy(host, spec, hlen);
+    host[hlen] = 0;
+
+    struct addrinfo hints = { .ai_flags = AI_PASSIVE | AI_NUMERICHOST | AI_NUMERICSERV,
+                              .ai_socktype = SOCK_STREAM };
+    struct addrinfo* res;
+    if(getaddrinfo(hlen ? host : NULL, colon + 1, &hints, &res) != 0){ errno = EINVAL; return -1; }
+
+    int fd = socket(res->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(fd >= 0){
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if(bind(fd, res->ai_addr, res->ai_addrlen) != 0 || listen(fd, 128) != 0){
+            int err = errno;
+            close(fd);
+            fd = -1;
+            errno = err;
+        }
+    }
+    freeaddrinfo(res);
+    return fd;
+}
+
+static void client_drop(int ep, exporter_client_t** slot){
+    epoll_ctl(ep, EPOLL_CTL_DEL, (*slot)->fd, NULL);
+    close((*slot)->fd);
+    free((*slot)->data);
+    free(*slot);
+    *slot = NULL;
+}
+
+// Write as much as the socket takes; returns 1 once the response is out.
+static int client_flush(exporter_client_t* c){
+    while(c->sent < c->len){
+        ssize_t w = write(c->fd, c->data + c->sent, c->len - c->sent);
+        if(w > 0){ c->sent += (size_t)w; continue; }
+        if(w < 0 && errno == EINTR) continue;
+        if(w < 0 && errno == EAGAIN) return 0;
+        return 1;   // peer went away, nothing left to do
+    }
+    return 1;
+}
+
+static int client_respond(exporter_client_t* c, const char* status, const char* type,
+                          const char* body, size_t body_len, int head_only){
+    char hdr[256];
+    int h = snprintf(hdr, sizeof(hdr),
+                     "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+                     status, type, body_len);
+    size_t len = (size_t)h + (head_only ? 0 : body_len);
+    c->data = malloc(len);
+    if(!c->data) return -1;
+    memcpy(c->data, hdr, (size_t)h);
+    if(!head_only) memcpy(c->data + h, body, body_len);
+    c->len = len;
+    c->sent = 0;
+    return 0;
+}
+
+// Answer once the request head is in; only the request line matters.
+static int client_request(exporter_t* e, exporter_client_t* c){
+    c->req[c->req_len] = 0;
+    if(!strstr(c->req, "\r\n\r\n") && !strstr(c->req, "\n\n"))
+        return c->req_len + 1 >= sizeof(c->req) ? -1 : 0;
+
+    char method[8], target[256];
+    if(sscanf(c->req, "%7s %255s", method, target) != 2) return -1;
+    int head_only = strcmp(method, "HEAD") == 0;
+    if(!head_only && strcmp(method, "GET") != 0)
+        return client_respond(c, "405 Method Not Allowed", "text/plain", "GET only\n", 9, 0) == 0 ? 1 : -1;
+
+    char* query = strchr(target, '?');
+    if(query) *query = 0;
+    if(strcmp(target, "/metrics") == 0){
+        exporter_sample(e);
+        return client_respond(c, "200 OK", EXPORTER_CONTENT_TYPE, e->body.buf, e->body.len, head_only) == 0 ? 1 : -1;
+    }
+    if(strcmp(target, "/") == 0){
+        static const char index[] = "xfetch exporter: metrics at /metrics\n";
+        return client_respond(c, "200 OK", "text/plain", index, sizeof(index) - 1, head_only) == 0 ? 1 : -1;
+    }
+    return client_respond(c, "404 Not Found", "text/plain", "not found\n", 10, head_only) == 0 ? 1 : -1;
+}
+
+static void exporter_accept(int ep, int lfd, exporter_client_t** clients){
+    for(;;){
+        int fd = accept4(lfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(fd < 0) return;
+
+        int slot = -1;
+        for(int i=0;i<EXPORTER_MAX_CLIENTS;i++){ if(!clients[i]){ slot = i; break; } }
+        exporter_client_t* c = slot >= 0 ? malloc(sizeof(*c)) : NULL;
+        if(!c){ close(fd); continue; }
+
+        c->fd = fd;
+        c->deadline = uf_now_ms() + EXPORTER_CLIENT_TIMEOUT_MS;
+        c->req_len = 0;
+        c->sent = c->len = 0;
+        c->data = NULL;
+        struct epoll_event ev = { .events = EPOLLIN, .data.u32 = (uint32_t)slot + 3 };
+        if(epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev) != 0){ close(fd); free(c); continue; }
+        clients[slot] = c;
+    }
+}
+
+// Returns 1 when the client is done with (served, failed or gone).
+static int client_event(int ep, exporter_t* e, exporter_client_t* c, uint32_t tag, uint32_t events){
+    if(events & EPOLLERR) return 1;
+    if(c->data) return client_flush(c);
+
+    for(;;){
+        ssize_t r = read(c->fd, c->req + c->req_len, sizeof(c->req) - 1 - c->req_len);
+        if(r < 0 && errno == EINTR) continue;
+        if(r < 0 && errno == EAGAIN) return 0;
+        if(r <= 0) return 1;
+        c->req_len += (size_t)r;
+        int ready = client_request(e, c);
+        if(ready < 0) return 1;
+        if(ready == 0) continue;
+        if(client_flush(c)) return 1;
+        // response did not fit in the socket buffer, finish it on EPOLLOUT
+        struct epoll_event ev = { .events = EPOLLOUT, .data.u32 = tag };
+        return epoll_ctl(ep, EPOLL_CTL_MOD, c->fd, &ev) != 0;
+    }
+}
+
+int uf_exporter_serve(const char* listen_spec, int min_interval_ms, int jobs, int use_cache){
+    if(min_interval_ms <= 0) min_interval_ms = 1000;
+
+    sigset_t mask;
+    block_signals(&mask);
+
+    int lfd = exporter_listen(listen_spec);
+    if(lfd < 0){
+        fprintf(stderr, "ultrafetch: cannot listen on %s: %s\n", listen_spec, strerror(errno));
+        return -1;
+    }
+    int sfd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    int ep = epoll_create1(EPOLL_CLOEXEC);
+    if(sfd < 0 || tfd < 0 || ep < 0){
+        close(lfd);
+        return -1;
+    }
+
+    // once a second: drop clients that never finished their request
+    struct itimerspec its = { .it_interval = { 1, 0 }, .it_value = { 1, 0 } };
+    timerfd_settime(tfd, 0, &its, NULL);
+
+    struct epoll_event ev = { .events = EPOLLIN };
+    ev.data.u32 = 0; epoll_ctl(ep, EPOLL_CTL_ADD, lfd, &ev);
+    ev.data.u32 = 1; epoll_ctl(ep, EPOLL_CTL_ADD, tfd, &ev);
+    ev.data.u32 = 2; epoll_ctl(ep, EPOLL_CTL_ADD, sfd, &ev);
+
+    exporter_t* e = &exp_state;
+    exporter_init(e, min_interval_ms, jobs, use_cache);
+
+    exporter_client_t* clients[EXPORTER_MAX_CLIENTS] = {0};
+    int running = 1;
+    while(running){
+        struct epoll_event events[16];
+        int nev = epoll_wait(ep, events, 16, -1);
+        if(nev < 0){
+            if(errno == EINTR) continue;
+            break;
+        }
+        for(int i=0;i<nev;i++){
+            uint32_t tag = events[i].data.u32;
+            if(tag == 0){
+                exporter_accept(ep, lfd, clients);
+            } else if(tag == 1){
+                uint64_t ticks;
+                if(read(tfd, &ticks, sizeof(ticks)) != sizeof(ticks)) continue;
+                long long now = uf_now_ms();
+                for(int c=0;c<EXPORTER_MAX_CLIENTS;c++){
+                    if(clients[c] && now > clients[c]->deadline) client_drop(ep, &clients[c]);
+                }
+            } else if(tag == 2){
+                running = 0;
+            } else {
+                exporter_client_t** slot = &clients[tag - 3];
+                if(*slot && client_event(ep, e, *slot, tag, events[i].events))
+                    client_drop(ep, slot);
+            }
+        }
+    }
+
+    for(int i=0;i<EXPORTER_MAX_CLIENTS;i++){ if(clients[i]) client_drop(ep, &clients[i]); }
+    close(ep); close(tfd); close(sfd); close(lfd);
+    return 0;
+}
@@ -0,0 +1,156 @@
+// src/fact.c — typed module results and their one-line encoding
+#include "common.h"
+#include "fact.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// encoded type tag, indexed by uf_fact_type_t
+static const char type_tags[] = "-sibtmcp";
+#define FIELD_SEP '\x1f'
+
+void uf_fact_init(uf_fact_t* f){
+    f->count = 0;
+    f->pool_len = 0;
+}
+
+static uf_field_t* fact_add(uf_fact_t* f, const char* key, uf_fact_type_t type){
+    if(f->count >= UF_FACT_FIELDS) return NULL;
+    uf_field_t* fld = &f->field[f->count++];
+    snprintf(fld->key, sizeof(fld->key), "%s", key);
+    fld->type = (unsigned char)type;
+    fld->v.i = 0;
+    return fld;
+}
+
+static void fact_add_str(uf_fact_t* f, const char* key, const char* s, size_t len){
+    if(!s || len == 0 || f->pool_len + 1 >= UF_FACT_POOL){ uf_fact_none(f, key); return; }
+    size_t room = (size_t)(UF_FACT_POOL - f->pool_len) - 1;
+    if(len > room) len = room;   // clip to what is left
+    uf_field_t* fld = fact_add(f, key, UF_FACT_STR);
+    if(!fld) return;
+    fld->v.s = f->pool_len;
+    char* dst = f->pool + f->pool_len;
+    for(size_t i = 0; i < len; i++)
+        dst[i] = (unsigned char)s[i] < 0x20 ? ' ' : s[i];
+    dst[len] = 0;
+    f->pool_len = (unsigned short)(f->pool_len + len + 1);
+}
+
+void uf_fact_str(uf_fact_t* f, const char* key, const char* s){
+    fact_add_str(f, key, s, s ? strlen(s) : 0);
+}
+
+void uf_fact_int(uf_fact_t* f, const char* key, uf_fact_type_t type, long long v){
+    uf_field_t* fld = fact_add(f, key, type);
+    if(fld) fld->v.i = v;
+}
+
+void uf_fact_num(uf_fact_t* f, const char* key, uf_fact_type_t type, double v){
+    uf_field_t* fld = fact_add(f, key, type);
+    if(fld) fld->v.d = v;
+}
+
+void uf_fact_none(uf_fact_t* f, const char* key){
+    fact_add(f, key, UF_FACT_NONE);
+}
+
+void uf_fact_set_num(uf_fact_t* f, const char* key, uf_fact_type_t type, double v){
+    for(int i = 0; i < f->count; i++){
+        if(strcmp(f->field[i].key, key) != 0) continue;
+        f->field[i].type = (unsigned char)type;
+        f->field[i].v.d = v;
+        return;
+    }
+    uf_fact_num(f, key, type, v);
+}
+
+const uf_field_t* uf_fact_get(const uf_fact_t* f, const char* key){
+    for(int i = 0; i < f->count; i++){
+        if(strcmp(f->field[i].key, key) == 0)
+            return f->field[i].type == UF_FACT_NONE ? NULL : &f->field[i];
+    }
+    return NULL;
+}
+
+const char* uf_fact_field_str(const uf_fact_t* f, const uf_field_t* fld){
+    return fld->type == UF_FACT_STR ? f->pool + fld->v.s : "";
+}
+
+const char* uf_fact_get_str(const uf_fact_t* f, const char* key){
+    const uf_field_t* fld = uf_fact_get(f, key);
+    return fld && fld->type == UF_FACT_STR ? f->pool + fld->v.s : NULL;
+}
+
+long long uf_fact_get_int(const uf_fact_t* f, const char* key, long long def){
+    const uf_field_t* fld = uf_fact_get(f, key);
+    if(!fld || fld->type == UF_FACT_STR) return def;
+    return fld->type >= UF_FACT_MHZ ? (long long)fld->v.d : fld->v.i;
+}
+
+double uf_fact_get_num(const uf_fact_t* f, const char* key, double def){
+    const uf_field_t* fld = uf_fact_get(f, key);
+    if(!fld || fld->type == UF_FACT_STR) return def;
+    return fld->type >= UF_FACT_MHZ ? fld->v.d : (double)fld->v.i;
+}
+
+size_t uf_fact_encode(const uf_fact_t* f, char* out, size_t n){
+    size_t len = 0;
+    if(!out || n == 0) return 0;
+    out[0] = 0;
+    for(int i = 0; i < f->count; i++){
+        const uf_field_t* fld = &f->field[i];
+        const char* sep = i ? "\x1f" : "";
+        char tag = type_tags[fld->type];
+        int w;
+        switch(fld->type){
+        case UF_FACT_STR:
+            w = snprintf(out + len, n - len, "%s%s=%c%s", sep, fld->key, tag, f->pool + fld->v.s);
+            break;
+        case UF_FACT_INT: case UF_FACT_BYTES: case UF_FACT_SECONDS:
+            w = snprintf(out + len, n - len, "%s%s=%c%lld", sep, fld->key, tag, fld->v.i);
+            break;
+        case UF_FACT_MHZ: case UF_FACT_CELSIUS: case UF_FACT_PERCENT:
+            w = snprintf(out + len, n - len, "%s%s=%c%.9g", sep, fld->key, tag, fld->v.d);
+            break;
+        default:
+            w = snprintf(out + len, n - len, "%s%s=%c", sep, fld->key, tag);
+        }
+        if(w < 0 || (size_t)w >= n - len){ out[len] = 0; break; }
+        len += (size_t)w;
+    }
+    return len;
+}
+
+int uf_fact_decode(uf_fact_t* f, const char* s, size_t len){
+    const char* end = s + len;
+    uf_fact_init(f);
+    while(s < end){
+        const char* next = memchr(s, FIELD_SEP, (size_t)(end - s));
+        if(!next) next = end;
+        const char* eq = memchr(s, '=', (size_t)(next - s));
+        if(eq && eq + 1 < next && (size_t)(eq - s) < UF_FACT_KEY){
+            char key[UF_FACT_KEY];
+            memcpy(key, s, (size_t)(eq - s));
+            key[eq - s] = 0;
+            const char* tag = strchr(type_tags, eq[1]);
+            const char* val = eq + 2;
+            char num[40];
+            size_t vlen = (size_t)(next - val);
+            snprintf(num, sizeof(num), "%.*s", (int)(vlen < sizeof(num) ? vlen : sizeof(num) - 1), val);
+            uf_fact_type_t type = tag && *tag ? (uf_fact_type_t)(tag - type_tags) : UF_FACT_NONE;
+            switch(type){
+            case UF_FACT_STR: fact_add_str(f, key, val, vlen); break;
+            case UF_FACT_INT: case UF_FACT_BYTES: case UF_FACT_SECONDS:
+                uf_fact_int(f, key, type, strtoll(num, NULL, 10));
+                break;
+            case UF_FACT_MHZ: case UF_FACT_CELSIUS: case UF_FACT_PERCENT:
+                uf_fact_num(f, key, type, strtod(num, NULL));
+                break;
+            default: uf_fact_none(f, key);
+            }
+        }
+        s = next + 1;
+    }
+    return f->count;
+}
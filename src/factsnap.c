@@ -0,0 +1,262 @@
+// src/factsnap.c — binary fact snapshots and the field-by-field diff
+#include "common.h"
+#include "factsnap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define FACTSNAP_MAGIC "XFFACT"
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+    uint32_t pool_off;
+    uint32_t pool_len;
+} factsnap_header_t;
+
+typedef struct {
+    uint32_t module_off;
+    uint32_t key_off;
+    uint32_t type;
+    uint32_t str_len;
+    union {
+        int64_t i;
+        double d;
+        uint64_t str_off;
+    } v;
+} factsnap_field_t;
+
+// one field while building, before its place in the table is known
+typedef struct {
+    const char* module;
+    const uf_fact_t* fact;
+    const uf_field_t* fld;
+} build_item_t;
+
+static int build_cmp(const void* a, const void* b){
+    const build_item_t* x = a;
+    const build_item_t* y = b;
+    int c = strcmp(x->module, y->module);
+    return c ? c : strcmp(x->fld->key, y->fld->key);
+}
+
+static uint32_t pool_put(unsigned char* base, size_t* at, const char* s){
+    size_t n = strlen(s) + 1;
+    uint32_t off = (uint32_t)*at;
+    memcpy(base + *at, s, n);
+    *at += n;
+    return off;
+}
+
+int uf_factsnap_build(uf_factsnap_t* s, const uf_registry_t* reg){
+    build_item_t items[UF_MOD_COUNT * UF_FACT_FIELDS];
+    size_t count = 0, pool = 0;
+    for(int m=0;m<UF_MOD_COUNT;m++){
+        if(!reg->ready[m]) continue;
+        const uf_fact_t* f = &reg->fact[m];
+        for(int i=0;i<f->count;i++){
+            const uf_field_t* fld = &f->field[i];
+            items[count++] = (build_item_t){ uf_modules[m].key, f, fld };
+            pool += strlen(uf_modules[m].key) + strlen(fld->key) + 2;
+            if(fld->type == UF_FACT_STR) pool += strlen(uf_fact_field_str(f, fld)) + 1;
+        }
+    }
+    qsort(items, count, sizeof(items[0]), build_cmp);
+
+    size_t pool_off = sizeof(factsnap_header_t) + count * sizeof(factsnap_field_t);
+    s->len = pool_off + pool;
+    s->base = calloc(1, s->len);
+    s->mapped = 0;
+    if(!s->base) return -1;
+
+    factsnap_header_t* hdr = (factsnap_header_t*)s->base;
+    memcpy(hdr->magic, FACTSNAP_MAGIC, sizeof(FACTSNAP_MAGIC));
+    hdr->version = UF_FACTSNAP_VERSION;
+    hdr->count = (uint32_t)count;
+    hdr->pool_off = (uint32_t)pool_off;
+    hdr->pool_len = (uint32_t)pool;
+
+    factsnap_field_t* table = (factsnap_field_t*)(s->base + sizeof(*hdr));
+    size_t at = pool_off;
+    for(size_t i=0;i<count;i++){
+        const uf_field_t* fld = items[i].fld;
+        factsnap_field_t* e = &table[i];
+        e->module_off = pool_put(s->base, &at, items[i].module);
+        e->key_off = pool_put(s->base, &at, fld->key);
+        e->type = fld->type;
+        switch(fld->type){
+        case UF_FACT_STR: {
+            const char* str = uf_fact_field_str(items[i].fact, fld);
+            e->str_len = (uint32_t)strlen(str);
+            e->v.str_off = pool_put(s->base, &at, str);
+            break;
+        }
+        case UF_FACT_INT: case UF_FACT_BYTES: case UF_FACT_SECONDS:
+            e->v.i = fld->v.i;
+            break;
+        case UF_FACT_MHZ: case UF_FACT_CELSIUS: case UF_FACT_PERCENT:
+            e->v.d = fld->v.d;
+            break;
+        }
+    }
+    return 0;
+}
+
+int uf_factsnap_save(const uf_factsnap_t* s, const char* path){
+    char tmp[4096 + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE* f = fopen(tmp, "wb");
+    int ok = f != NULL;
+    if(ok) ok = fwrite(s->base, s->len, 1, f) == 1;
+    if(f && fclose(f) != 0) ok = 0;
+    if(ok) ok = rename(tmp, path) == 0;
+    if(!ok){
+        unlink(tmp);
+        fprintf(stderr, "ultrafetch: cannot write %s: %s\n", path, strerror(errno));
+    }
+    return ok ? 0 : -1;
+}
+
+int uf_factsnap_open(uf_factsnap_t* s, const char* path){
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if(fd < 0) return -1;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(factsnap_header_t)){
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+    size_t len = (size_t)st.st_size;
+    unsigned char* base = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(base == MAP_FAILED) return -1;
+
+    // bounds-check once so the diff can trust every offset
+    const factsnap_header_t* hdr = (const factsnap_header_t*)base;
+    uint64_t table_end = sizeof(*hdr) + (uint64_t)hdr->count * sizeof(factsnap_field_t);
+    uint64_t pool_end = (uint64_t)hdr->pool_off + hdr->pool_len;
+    int ok = memcmp(hdr->magic, FACTSNAP_MAGIC, sizeof(FACTSNAP_MAGIC)) == 0 &&
+             hdr->version == UF_FACTSNAP_VERSION &&
+             table_end <= hdr->pool_off && pool_end <= len &&
+             (hdr->count == 0 || (hdr->pool_len > 0 && base[pool_end - 1] == 0));
+
+    const factsnap_field_t* table = (const factsnap_field_t*)(base + sizeof(*hdr));
+    for(uint32_t i=0;ok && i<hdr->count;i++){
+        const factsnap_field_t* e = &table[i];
+        ok = e->module_off >= hdr->pool_off && e->module_off < pool_end &&
+             e->key_off >= hdr->pool_off && e->key_off < pool_end &&
+             e->type <= UF_FACT_PERCENT;
+        if(ok && e->type == UF_FACT_STR)
+            ok = e->v.str_off >= hdr->pool_off && e->v.str_off < pool_end &&
+                 e->v.str_off + e->str_len < pool_end &&
+                 base[e->v.str_off + e->str_len] == 0;
+    }
+    if(!ok){ munmap(base, len); errno = EINVAL; return -1; }
+
+    s->base = base;
+    s->len = len;
+    s->mapped = 1;
+    return 0;
+}
+
+void uf_factsnap_close(uf_factsnap_t* s){
+    if(!s->base) return;
+    if(s->mapped) munmap(s->base, s->len);
+    else free(s->base);
+    s->base = NULL;
+    s->len = 0;
+}
+
+static const factsnap_field_t* snap_table(const uf_factsnap_t* s, uint32_t* count){
+    *count = ((const factsnap_header_t*)s->base)->count;
+    return (const factsnap_field_t*)(s->base + sizeof(factsnap_header_t));
+}
+
+static const char* snap_str(const uf_factsnap_t* s, uint64_t off){
+    return (const char*)s->base + off;
+}
+
+static int field_cmp(const uf_factsnap_t* a, const factsnap_field_t* x,
+                     const uf_factsnap_t* b, const factsnap_field_t* y){
+    int c = strcmp(snap_str(a, x->module_off), snap_str(b, y->module_off));
+    return c ? c : strcmp(snap_str(a, x->key_off), snap_str(b, y->key_off));
+}
+
+static int field_same(const uf_factsnap_t* a, const factsnap_field_t* x,
+                      const uf_factsnap_t* b, const factsnap_field_t* y){
+    if(x->type != y->type) return 0;
+    switch(x->type){
+    case UF_FACT_STR:
+        return x->str_len == y->str_len &&
+               memcmp(snap_str(a, x->v.str_off), snap_str(b, y->v.str_off), x->str_len) == 0;
+    case UF_FACT_INT: case UF_FACT_BYTES: case UF_FACT_SECONDS:
+        return x->v.i == y->v.i;
+    case UF_FACT_MHZ: case UF_FACT_CELSIUS: case UF_FACT_PERCENT:
+        return x->v.d == y->v.d;
+    default:
+        return 1;
+    }
+}
+
+// A missing field and an undetected one read the same.
+static void put_value(uf_frame_t* out, const uf_factsnap_t* s, const factsnap_field_t* e){
+    switch(e ? e->type : UF_FACT_NONE){
+    case UF_FACT_STR:
+        uf_frame_put(out, snap_str(s, e->v.str_off), e->str_len);
+        break;
+    case UF_FACT_INT: case UF_FACT_BYTES: case UF_FACT_SECONDS:
+        uf_frame_printf(out, "%lld", (long long)e->v.i);
+        break;
+    case UF_FACT_MHZ: case UF_FACT_CELSIUS: case UF_FACT_PERCENT:
+        uf_frame_printf(out, "%.9g", e->v.d);
+        break;
+    default:
+        uf_frame_puts(out, "(none)");
+    }
+}
+
+int uf_factsnap_diff(const uf_factsnap_t* a, const uf_factsnap_t* b,
+                     const unsigned char* select, uf_frame_t* out){
+    uint32_t na, nb, i = 0, j = 0;
+    const factsnap_field_t* ta = snap_table(a, &na);
+    const factsnap_field_t* tb = snap_table(b, &nb);
+    const char* last_module = NULL;
+    int wanted = 0, changes = 0;
+
+    // both tables are sorted by (module, key): one pass pairs them up
+    while(i < na || j < nb){
+        const factsnap_field_t* x = i < na ? &ta[i] : NULL;
+        const factsnap_field_t* y = j < nb ? &tb[j] : NULL;
+        int c = !x ? 1 : !y ? -1 : field_cmp(a, x, b, y);
+        const char* module = c <= 0 ? snap_str(a, x->module_off) : snap_str(b, y->module_off);
+        const char* key = c <= 0 ? snap_str(a, x->key_off) : snap_str(b, y->key_off);
+        if(c <= 0) i++;
+        if(c >= 0) j++;
+
+        if(!last_module || strcmp(module, last_module) != 0){
+            int id = uf_module_find(module);
+            wanted = id >= 0 && select[id];
+            last_module = module;
+        }
+        if(!wanted) continue;
+        if(c == 0 ? field_same(a, x, b, y) : (c < 0 ? x : y)->type == UF_FACT_NONE) continue;
+
+        // a string-only module's single field is the module itself
+        if(strcmp(key, "value") == 0) uf_frame_printf(out, "%s: ", module);
+        else uf_frame_printf(out, "%s.%s: ", module, key);
+        put_value(out, a, c <= 0 ? x : NULL);
+        uf_frame_puts(out, " -> ");
+        put_value(out, b, c >= 0 ? y : NULL);
+        uf_frame_put(out, "\n", 1);
+        changes++;
+    }
+    return changes;
+}
@@ -0,0 +1,217 @@
+// src/frame.c — single-buffer output frames and display-width layout
+#include "common.h"
+#include "frame.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+#define LOGO_GAP 3
+
+static const int rainbow[] = {196,202,208,214,220,226,190,82,46,49,51,39,33,27,93,129,201,198};
+
+void uf_frame_init(uf_frame_t* f, int fd){
+    f->len = 0;
+    f->fd = fd;
+}
+
+int uf_frame_flush(uf_frame_t* f){
+    size_t off = 0;
+    int rc = 0;
+    while(f->fd >= 0 && off < f->len){
+        ssize_t w = write(f->fd, f->buf + off, f->len - off);
+        if(w < 0 && errno == EINTR) continue;
+        if(w <= 0){ rc = -1; break; }
+        off += (size_t)w;
+    }
+    f->len = 0;
+    return rc;
+}
+
+void uf_frame_put(uf_frame_t* f, const char* s, size_t n){
+    while(n > 0){
+        size_t room = sizeof(f->buf) - f->len;
+        if(room == 0){
+            // a scratch frame just stops growing
+            if(f->fd < 0) return;
+            uf_frame_flush(f);
+            continue;
+        }
+        size_t k = n < room ? n : room;
+        memcpy(f->buf + f->len, s, k);
+        f->len += k;
+        s += k;
+        n -= k;
+    }
+}
+
+void uf_frame_puts(uf_frame_t* f, const char* s){
+    uf_frame_put(f, s, strlen(s));
+}
+
+void uf_frame_printf(uf_frame_t* f, const char* fmt, ...){
+    char tmp[1024];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(tmp, sizeof(tmp), fmt, ap);
+    va_end(ap);
+    if(n > 0) uf_frame_put(f, tmp, (size_t)n < sizeof(tmp) ? (size_t)n : sizeof(tmp) - 1);
+}
+
+void uf_frame_pad(uf_frame_t* f, int cols){
+    static const char spaces[] = "                                ";
+    while(cols > 0){
+        int k = cols < (int)sizeof(spaces) - 1 ? cols : (int)sizeof(spaces) - 1;
+        uf_frame_put(f, spaces, (size_t)k);
+        cols -= k;
+    }
+}
+
+typedef struct {
+    unsigned lo, hi;
+} range_t;
+
+static const range_t zero_width[] = {
+    {0x0300, 0x036f}, {0x200b, 0x200f}, {0x20d0, 0x20ff}, {0xfe00, 0xfe0f},
+    {0xfe20, 0xfe2f}, {0x1f3fb, 0x1f3ff}, {0xe0000, 0xe01ef},
+};
+
+// East Asian Wide/Fullwidth blocks and the emoji that default to emoji
+// presentation; enough for labels, icons and distro names
+static const range_t wide[] = {
+    {0x1100, 0x115f}, {0x231a, 0x231b}, {0x23e9, 0x23ec}, {0x23f0, 0x23f0},
+    {0x23f3, 0x23f3}, {0x25fd, 0x25fe}, {0x2614, 0x2615}, {0x2648, 0x2653},
+    {0x267f, 0x267f}, {0x2693, 0x2693}, {0x26a1, 0x26a1}, {0x26aa, 0x26ab},
+    {0x26bd, 0x26be}, {0x26c4, 0x26c5}, {0x26ce, 0x26ce}, {0x26d4, 0x26d4},
+    {0x26ea, 0x26ea}, {0x26f2, 0x26f3}, {0x26f5, 0x26f5}, {0x26fa, 0x26fa},
+    {0x26fd, 0x26fd}, {0x2705, 0x2705}, {0x270a, 0x270b}, {0x2728, 0x2728},
+    {0x274c, 0x274c}, {0x274e, 0x274e}, {0x2753, 0x2755}, {0x2757, 0x2757},
+    {0x2795, 0x2797}, {0x27b0, 0x27b0}, {0x27bf, 0x27bf}, {0x2b1b, 0x2b1c},
+    {0x2b50, 0x2b50}, {0x2b55, 0x2b55}, {0x2e80, 0x303e}, {0x3041, 0x33ff},
+    {0x3400, 0x4dbf}, {0x4e00, 0x9fff}, {0xa000, 0xa4cf}, {0xac00, 0xd7a3},
+    {0xf900, 0xfaff}, {0xfe30, 0xfe4f}, {0xff00, 0xff60}, {0xffe0, 0xffe6},
+    {0x1f004, 0x1f004}, {0x1f0cf, 0x1f0cf}, {0x1f18e, 0x1f18e}, {0x1f191, 0x1f19a},
+    {0x1f200, 0x1f251}, {0x1f300, 0x1f64f}, {0x1f680, 0x1f6ff}, {0x1f7e0, 0x1f7eb},
+    {0x1f900, 0x1f9ff}, {0x1fa70, 0x1faff}, {0x20000, 0x3fffd},
+};
+
+static int in_ranges(unsigned cp, const range_t* r, size_t n){
+    size_t lo = 0, hi = n;
+    while(lo < hi){
+        size_t mid = lo + (hi - lo) / 2;
+        if(cp < r[mid].lo) hi = mid;
+        else if(cp > r[mid].hi) lo = mid + 1;
+        else return 1;
+    }
+    return 0;
+}
+
+// Decode one UTF-8 sequence; malformed bytes count as one narrow character.
+static size_t decode(const unsigned char* s, size_t n, unsigned* cp){
+    unsigned c = s[0];
+    size_t len = c < 0x80 ? 1 : (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xe ? 3 : (c >> 3) == 0x1e ? 4 : 0;
+    if(len == 0 || len > n){ *cp = 0xfffd; return 1; }
+    if(len == 1){ *cp = c; return 1; }
+    unsigned v = c & (0x7f >> len);
+    for(size_t i = 1; i < len; i++){
+        if((s[i] & 0xc0) != 0x80){ *cp = 0xfffd; return 1; }
+        v = v << 6 | (s[i] & 0x3f);
+    }
+    *cp = v;
+    return len;
+}
+
+int uf_text_width(const char* text, size_t n){
+    const unsigned char* s = (const unsigned char*)text;
+    int width = 0, last = 0;
+    size_t i = 0;
+    while(i < n){
+        if(s[i] == 0x1b){
+            // CSI: ESC [ params final-byte; anything else: ESC + one byte
+            i++;
+            if(i < n && s[i] == '['){
+                i++;
+                while(i < n && (s[i] < 0x40 || s[i] > 0x7e)) i++;
+            }
+            if(i < n) i++;
+            continue;
+        }
+        unsigned cp;
+        i += decode(s + i, n - i, &cp);
+        if(cp < 0x20 || (cp >= 0x7f && cp < 0xa0)) continue;
+        if(cp == 0xfe0f && last == 1){
+            // VS16 asks for emoji presentation of the symbol before it
+            width++;
+            last = 2;
+            continue;
+        }
+        if(in_ranges(cp, zero_width, sizeof(zero_width) / sizeof(zero_width[0]))) continue;
+        last = in_ranges(cp, wide, sizeof(wide) / sizeof(wide[0])) ? 2 : 1;
+        width += last;
+    }
+    return width;
+}
+
+// next '\n' terminated line of [*p, end); returns its length without the '\n'
+static size_t next_line(const char** p, const char* end, const char** line){
+    *line = *p;
+    const char* eol = memchr(*p, '\n', (size_t)(end - *p));
+    size_t len = eol ? (size_t)(eol - *p) : (size_t)(end - *p);
+    *p = eol ? eol + 1 : end;
+    return len;
+}
+
+void uf_frame_compose(uf_frame_t* f, const char* art, const char* info, size_t info_len,
+                      int side_by_side, uf_layout_t* layout){
+    const int ncolors = (int)(sizeof(rainbow) / sizeof(rainbow[0]));
+    const char* art_end = art ? art + strlen(art) : art;
+    const char* info_end = info + info_len;
+
+    int logo_rows = 0, logo_width = 0, info_rows = 0;
+    const char* line;
+    for(const char* p = art; p < art_end; logo_rows++){
+        int w = uf_text_width(line, next_line(&p, art_end, &line));
+        if(w > logo_width) logo_width = w;
+    }
+    for(const char* p = info; p < info_end; info_rows++) next_line(&p, info_end, &line);
+
+    if(!side_by_side || logo_rows == 0){
+        // the reset follows the newline, so every row after the first opens with it
+        const char* p = art;
+        for(int row = 0; p < art_end; row++){
+            size_t len = next_line(&p, art_end, &line);
+            uf_frame_printf(f, "\033[38;5;%dm", rainbow[row % ncolors]);
+            uf_frame_put(f, line, len + (line + len < art_end));
+            uf_frame_puts(f, "\033[0m");
+        }
+        uf_frame_put(f, info, info_len);
+        layout->info_top = logo_rows;
+        layout->info_col = 1;
+        layout->rows = logo_rows + info_rows;
+        return;
+    }
+
+    const char* a = art;
+    const char* b = info;
+    int rows = logo_rows > info_rows ? logo_rows : info_rows;
+    for(int row = 0; row < rows; row++){
+        int w = 0;
+        if(a < art_end){
+            size_t len = next_line(&a, art_end, &line);
+            w = uf_text_width(line, len);
+            uf_frame_printf(f, "\033[38;5;%dm", rainbow[row % ncolors]);
+            uf_frame_put(f, line, len);
+            uf_frame_puts(f, "\033[0m");
+        }
+        if(b < info_end){
+            uf_frame_pad(f, logo_width - w + LOGO_GAP);
+            size_t len = next_line(&b, info_end, &line);
+            uf_frame_put(f, line, len);
+        }
+        uf_frame_put(f, "\n", 1);
+    }
+    layout->info_top = 0;
+    layout->info_col = logo_width + LOGO_GAP + 1;
+    layout->rows = rows;
+}
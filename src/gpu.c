@@ -1,6 +1,13 @@
 #include "common.h"
 #include "gpu.h"
+#include "fact.h"
+#include "pci.h"
+#include "pciids.h"
+#include "mapping.h"
+#include "props.h"
+#include "trace.h"
 #include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -11,6 +18,7 @@
 #include <errno.h>
 
 #define GPU_BUFFER_SIZE 1024
+#define GPU_OUTPUT_SIZE 4096
 #define FF_GPU_TEMP_UNSET -1000.0
 #define MAX_GPU_COUNT 8
 
@@ -50,7 +58,6 @@ typedef enum {
 
 typedef struct {
     FFGPUDetectionMethod detectionMethod;
-    int temp;
     int hideType;
 } FFGPUOptions;
 
@@ -64,11 +71,9 @@ typedef struct {
     const char* error;
 } FFOpenCLResult;
 
-static int read_file_content(const char* path, char* buffer, size_t size);
-static int read_sysfs_value(const char* base_path, const char* file, char* buffer, size_t size);
-static int detect_nvidia_gpu(gpu_result_t* gpu);
-static int detect_amd_gpu(gpu_result_t* gpu);
-static int detect_intel_gpu(gpu_result_t* gpu);
+static int detect_nvidia_gpu(const uf_pci_dev_t* dev, gpu_result_t* gpu);
+static int detect_amd_gpu(const uf_pci_dev_t* dev, gpu_result_t* gpu);
+static int detect_intel_gpu(const uf_pci_dev_t* dev, gpu_result_t* gpu);
 static int detect_vulkan_gpu(FFlist* result);
 static int detect_opencl_gpu(FFlist* result);
 static int detect_opengl_gpu(FFlist* result);
@@ -77,10 +82,8 @@ static void trim_string(char* str);
 static int string_starts_with(const char* str, const char* prefix);
 static int string_contains(const char* haystack, const char* needle);
 static int get_android_property(const char* prop, char* buffer, size_t size);
-static double parseTZDir(int dfd, char* buffer, size_t buffer_size);
+static double parseTZDir(const char* dir, char* buffer, size_t buffer_size);
 static double ffGPUDetectTempFromTZ(void);
-static int ffReadFileBufferRelative(int dfd, const char* filename, char* buffer, size_t size);
-static int ffStrbufStartsWithS(const char* buffer, const char* prefix);
 static double ffStrbufToDouble(const char* buffer, double fallback);
 static FFVulkanResult* ffDetectVulkan(void);
 static FFOpenCLResult* ffDetectOpenCL(void);
@@ -91,54 +94,6 @@ static void ffListInitMove(FFlist* dest, FFlist* src);
 static void ffListInit(FFlist* list, size_t element_size);
 static void ffListAdd(FFlist* list, const void* item);
 
-static int read_file_content(const char* path, char* buffer, size_t size) {
-    if (!path || !buffer || size == 0) return 0;
-    
-    int fd = open(path, O_RDONLY | O_CLOEXEC);
-    if (fd < 0) return 0;
-    
-    ssize_t bytes_read = read(fd, buffer, size - 1);
-    close(fd);
-    
-    if (bytes_read > 0) {
-        buffer[bytes_read] = '\0';
-        trim_string(buffer);
-        return bytes_read > 0 && buffer[0] != '\0';
-    }
-    return 0;
-}
-
-static int read_sysfs_value(const char* base_path, const char* file, char* buffer, size_t size) {
-    if (!base_path || !file) return 0;
-    
-    char full_path[512];
-    int ret = snprintf(full_path, sizeof(full_path), "%s/%s", base_path, file);
-    if (ret >= (int)sizeof(full_path) || ret < 0) return 0;
-    
-    return read_file_content(full_path, buffer, size);
-}
-
-static int ffReadFileBufferRelative(int dfd, const char* filename, char* buffer, size_t size) {
-    if (!filename || !buffer || size == 0) return 0;
-    
-    int fd = openat(dfd, filename, O_RDONLY | O_CLOEXEC);
-    if (fd < 0) return 0;
-    
-    ssize_t bytes_read = read(fd, buffer, size - 1);
-    close(fd);
-    
-    if (bytes_read > 0) {
-        buffer[bytes_read] = '\0';
-        trim_string(buffer);
-        return 1;
-    }
-    return 0;
-}
-
-static int ffStrbufStartsWithS(const char* buffer, const char* prefix) {
-    return string_starts_with(buffer, prefix);
-}
-
 static double ffStrbufToDouble(const char* buffer, double fallback) {
     if (!buffer) return fallback;
     
@@ -154,12 +109,43 @@ static double ffStrbufToDouble(const char* buffer, double fallback) {
     return value;
 }
 
-static int detect_nvidia_gpu(gpu_result_t* gpu) {
+// pci.ids keeps the marketing name in brackets after the chip code name,
+// "GA102GL [RTX A6000]"; boards from the chip vendor itself have a more
+// precise subsystem entry than the chip, so that one wins when present.
+static int pciids_gpu_name(const char* vendor, const uf_pci_dev_t* dev, char* out, size_t n) {
+    char name[256];
+    if (!(dev->subsystem_vendor == dev->vendor &&
+          uf_pciids_subsystem(dev->vendor, dev->device, dev->subsystem_vendor,
+                              dev->subsystem_device, name, sizeof(name))) &&
+        !uf_pciids_device(dev->vendor, dev->device, name, sizeof(name))) {
+        return 0;
+    }
+    
+    const char* model = name;
+    size_t len = strlen(name);
+    char* open = strchr(name, '[');
+    char* close = strrchr(name, ']');
+    if (open && close && close > open + 1) {
+        model = open + 1;
+        len = (size_t)(close - model);
+    }
+    
+    size_t vlen = strlen(vendor);
+    if (strncmp(model, vendor, vlen) == 0 && model[vlen] == ' ') {
+        snprintf(out, n, "%.*s", (int)len, model);
+    } else {
+        snprintf(out, n, "%s %.*s", vendor, (int)len, model);
+    }
+    return 1;
+}
+
+static int detect_nvidia_gpu(const uf_pci_dev_t* dev, gpu_result_t* gpu) {
     char buffer[GPU_BUFFER_SIZE];
     memset(gpu, 0, sizeof(*gpu));
     
-    if (read_file_content("/proc/driver/nvidia/gpus/0/information", buffer, sizeof(buffer))) {
-        char* line = strtok(buffer, "\n");
+    if (uf_read_value(NULL, "/proc/driver/nvidia/gpus/0/information", buffer, sizeof(buffer))) {
+        char* save = NULL;
+        char* line = strtok_r(buffer, "\n", &save);
         while (line) {
             if (string_starts_with(line, "Model:")) {
                 char* model = line + 6;
@@ -169,191 +155,105 @@ static int detect_nvidia_gpu(gpu_result_t* gpu) {
                 strcpy(gpu->driver, "nvidia");
                 return 1;
             }
-            line = strtok(NULL, "\n");
+            line = strtok_r(NULL, "\n", &save);
         }
     }
     
-    FILE* f = popen("nvidia-smi --query-gpu=name,driver_version,memory.total --format=csv,noheader,nounits 2>/dev/null", "r");
-    if (f) {
-        if (fgets(buffer, sizeof(buffer), f) && strlen(buffer) > 0) {
-            pclose(f);
-            trim_string(buffer);
+    if (uf_exec_read("nvidia-smi --query-gpu=name,driver_version,memory.total --format=csv,noheader,nounits 2>/dev/null", buffer, sizeof(buffer))) {
+        char* save = NULL;
+        char* name = strtok_r(buffer, ",", &save);
+        char* driver = strtok_r(NULL, ",", &save);
+        char* memory = strtok_r(NULL, ",", &save);
+        
+        if (name) {
+            trim_string(name);
+            snprintf(gpu->name, sizeof(gpu->name), "%s", name);
+            strcpy(gpu->vendor, "NVIDIA");
             
-            char* name = strtok(buffer, ",");
-            char* driver = strtok(NULL, ",");
-            char* memory = strtok(NULL, ",");
+            if (driver) {
+                trim_string(driver);
+                snprintf(gpu->driver, sizeof(gpu->driver), "%s", driver);
+            }
             
-            if (name) {
-                trim_string(name);
-                snprintf(gpu->name, sizeof(gpu->name), "%s", name);
-                strcpy(gpu->vendor, "NVIDIA");
-                
-                if (driver) {
-                    trim_string(driver);
-                    snprintf(gpu->driver, sizeof(gpu->driver), "%s", driver);
-                }
-                
-                if (memory) {
-                    trim_string(memory);
-                    gpu->memory_mb = atoi(memory);
-                }
-                return 1;
+            if (memory) {
+                trim_string(memory);
+                gpu->memory_mb = atoi(memory);
             }
-        } else {
-            pclose(f);
+            return 1;
         }
     }
     
-    DIR* dir = opendir("/sys/class/drm/");
-    if (!dir) return 0;
-    
-    struct dirent* entry;
-    while ((entry = readdir(dir)) != NULL) {
-        if (!string_starts_with(entry->d_name, "card") || strchr(entry->d_name, '-')) continue;
-        
-        char card_path[256];
-        snprintf(card_path, sizeof(card_path), "/sys/class/drm/%s/device", entry->d_name);
-        
-        if (read_sysfs_value(card_path, "vendor", buffer, sizeof(buffer))) {
-            uint32_t vendor_id = strtoul(buffer, NULL, 0);
-            if (vendor_id == 0x10de) {
-                strcpy(gpu->vendor, "NVIDIA");
-                strcpy(gpu->driver, "nouveau");
-                
-                if (read_sysfs_value(card_path, "device", buffer, sizeof(buffer))) {
-                    snprintf(gpu->name, sizeof(gpu->name), "NVIDIA GPU [%s]", buffer);
-                } else {
-                    strcpy(gpu->name, "NVIDIA Graphics");
-                }
-                closedir(dir);
-                return 1;
-            }
-        }
+    strcpy(gpu->vendor, "NVIDIA");
+    snprintf(gpu->driver, sizeof(gpu->driver), "%s", dev->driver[0] ? dev->driver : "nouveau");
+    if (!pciids_gpu_name("NVIDIA", dev, gpu->name, sizeof(gpu->name))) {
+        snprintf(gpu->name, sizeof(gpu->name), "NVIDIA GPU [0x%04x]", dev->device);
     }
-    
-    closedir(dir);
-    return 0;
+    return 1;
 }
 
-static int detect_amd_gpu(gpu_result_t* gpu) {
+static int detect_amd_gpu(const uf_pci_dev_t* dev, gpu_result_t* gpu) {
     char buffer[GPU_BUFFER_SIZE];
     memset(gpu, 0, sizeof(*gpu));
     
-    FILE* f = popen("rocm-smi --showproductname --csv 2>/dev/null | tail -n +2", "r");
-    if (f) {
-        if (fgets(buffer, sizeof(buffer), f) && strlen(buffer) > 0) {
-            pclose(f);
-            trim_string(buffer);
-            if (!string_contains(buffer, "Not supported")) {
-                snprintf(gpu->name, sizeof(gpu->name), "%s", buffer);
-                strcpy(gpu->vendor, "AMD");
-                strcpy(gpu->driver, "amdgpu");
-                return 1;
-            }
-        } else {
-            pclose(f);
-        }
-    }
-    
-    DIR* dir = opendir("/sys/class/drm/");
-    if (!dir) return 0;
-    
-    struct dirent* entry;
-    while ((entry = readdir(dir)) != NULL) {
-        if (!string_starts_with(entry->d_name, "card") || strchr(entry->d_name, '-')) continue;
-        
-        char card_path[256];
-        snprintf(card_path, sizeof(card_path), "/sys/class/drm/%s/device", entry->d_name);
-        
-        if (read_sysfs_value(card_path, "vendor", buffer, sizeof(buffer))) {
-            uint32_t vendor_id = strtoul(buffer, NULL, 0);
-            if (vendor_id == 0x1002) {
-                strcpy(gpu->vendor, "AMD");
-                
-                if (read_sysfs_value(card_path, "driver", buffer, sizeof(buffer))) {
-                    snprintf(gpu->driver, sizeof(gpu->driver), "%s", buffer);
-                } else {
-                    strcpy(gpu->driver, "amdgpu");
-                }
-                
-                if (read_sysfs_value(card_path, "device", buffer, sizeof(buffer))) {
-                    snprintf(gpu->name, sizeof(gpu->name), "AMD GPU [%s]", buffer);
-                } else {
-                    strcpy(gpu->name, "AMD Radeon Graphics");
-                }
-                closedir(dir);
-                return 1;
-            }
-        }
-    }
-    
-    closedir(dir);
-    
-    const char* amd_libs[] = {
-        "/usr/lib/x86_64-linux-gnu/libdrm_amdgpu.so",
-        "/usr/lib/libdrm_amdgpu.so",
-        "/usr/lib64/libdrm_amdgpu.so",
-        NULL
-    };
-    
-    for (int i = 0; amd_libs[i]; i++) {
-        if (access(amd_libs[i], F_OK) == 0) {
+    if (uf_exec_read("rocm-smi --showproductname --csv 2>/dev/null | tail -n +2", buffer, sizeof(buffer))) {
+        if (!string_contains(buffer, "Not supported")) {
+            snprintf(gpu->name, sizeof(gpu->name), "%s", buffer);
             strcpy(gpu->vendor, "AMD");
-            strcpy(gpu->name, "AMD Radeon Graphics");
             strcpy(gpu->driver, "amdgpu");
             return 1;
         }
     }
     
-    return 0;
+    strcpy(gpu->vendor, "AMD");
+    snprintf(gpu->driver, sizeof(gpu->driver), "%s", dev->driver[0] ? dev->driver : "amdgpu");
+    if (!pciids_gpu_name("AMD", dev, gpu->name, sizeof(gpu->name))) {
+        snprintf(gpu->name, sizeof(gpu->name), "AMD GPU [0x%04x]", dev->device);
+    }
+    return 1;
 }
 
-static int detect_intel_gpu(gpu_result_t* gpu) {
-    char buffer[GPU_BUFFER_SIZE];
+static int detect_intel_gpu(const uf_pci_dev_t* dev, gpu_result_t* gpu) {
     memset(gpu, 0, sizeof(*gpu));
+    strcpy(gpu->vendor, "Intel");
+    snprintf(gpu->driver, sizeof(gpu->driver), "%s", dev->driver[0] ? dev->driver : "i915");
     
-    DIR* dir = opendir("/sys/class/drm/");
-    if (!dir) return 0;
+    uint32_t device_id = dev->device;
+    if (pciids_gpu_name("Intel", dev, gpu->name, sizeof(gpu->name))) {
+        return 1;
+    }
     
-    struct dirent* entry;
-    while ((entry = readdir(dir)) != NULL) {
-        if (!string_starts_with(entry->d_name, "card") || strchr(entry->d_name, '-')) continue;
-        
-        char card_path[256];
-        snprintf(card_path, sizeof(card_path), "/sys/class/drm/%s/device", entry->d_name);
-        
-        if (read_sysfs_value(card_path, "vendor", buffer, sizeof(buffer))) {
-            uint32_t vendor_id = strtoul(buffer, NULL, 0);
-            if (vendor_id == 0x8086) {
-                strcpy(gpu->vendor, "Intel");
-                
-                if (read_sysfs_value(card_path, "driver", buffer, sizeof(buffer))) {
-                    snprintf(gpu->driver, sizeof(gpu->driver), "%s", buffer);
-                } else {
-                    strcpy(gpu->driver, "i915");
-                }
-                
-                if (read_sysfs_value(card_path, "device", buffer, sizeof(buffer))) {
-                    uint32_t device_id = strtoul(buffer, NULL, 0);
-                    
-                    if ((device_id & 0xff00) == 0x5600) {
-                        strcpy(gpu->name, "Intel Arc Graphics");
-                    } else if ((device_id & 0xff00) == 0x4600 || (device_id & 0xff00) == 0x9a00) {
-                        strcpy(gpu->name, "Intel UHD Graphics");
-                    } else {
-                        snprintf(gpu->name, sizeof(gpu->name), "Intel Graphics [%04X]", device_id);
-                    }
-                } else {
-                    strcpy(gpu->name, "Intel Graphics");
-                }
-                closedir(dir);
-                return 1;
-            }
-        }
+    // exact device first, then the 0xNN00 family row
+    const char* name = uf_map_find_num(uf_map_intel_gpu, uf_map_intel_gpu_count, device_id);
+    if (!name) name = uf_map_find_num(uf_map_intel_gpu, uf_map_intel_gpu_count, device_id & 0xff00);
+    if (name) {
+        snprintf(gpu->name, sizeof(gpu->name), "%s", name);
+    } else {
+        snprintf(gpu->name, sizeof(gpu->name), "Intel Graphics [%04X]", device_id);
+    }
+    return 1;
+}
+
+// Any other display device pci.ids knows, e.g. a server BMC's ASPEED.
+static int detect_pciids_gpu(const uf_pci_dev_t* dev, gpu_result_t* gpu) {
+    char vendor[128];
+    memset(gpu, 0, sizeof(*gpu));
+    if (!uf_pciids_vendor(dev->vendor, vendor, sizeof(vendor))) return 0;
+    
+    // "Advanced Micro Devices, Inc. [AMD/ATI]" -> "AMD/ATI",
+    // "ASPEED Technology, Inc." -> "ASPEED"
+    char* open = strchr(vendor, '[');
+    char* close = strrchr(vendor, ']');
+    if (open && close && close > open + 1) {
+        *close = '\0';
+        memmove(vendor, open + 1, strlen(open + 1) + 1);
+    } else {
+        vendor[strcspn(vendor, " ,")] = '\0';
     }
     
-    closedir(dir);
-    return 0;
+    if (!pciids_gpu_name(vendor, dev, gpu->name, sizeof(gpu->name))) return 0;
+    snprintf(gpu->vendor, sizeof(gpu->vendor), "%s", vendor);
+    snprintf(gpu->driver, sizeof(gpu->driver), "%s", dev->driver);
+    return 1;
 }
 
 static int detect_vulkan_gpu(FFlist* result) {
@@ -363,20 +263,20 @@ static int detect_vulkan_gpu(FFlist* result) {
         if (!vulkan_lib) return 0;
     }
     
-    FILE* f = popen("vulkaninfo --summary 2>/dev/null | grep 'deviceName\\|GPU'", "r");
-    if (!f) {
-        f = popen("vulkaninfo 2>/dev/null | grep 'deviceName'", "r");
-        if (!f) {
-            dlclose(vulkan_lib);
-            return 0;
-        }
+    char output[GPU_OUTPUT_SIZE];
+    if (uf_spawn_read("vulkaninfo --summary 2>/dev/null | grep 'deviceName\\|GPU'", output, sizeof(output)) <= 0 &&
+        (uf_deadline_hit() || uf_spawn_read("vulkaninfo 2>/dev/null | grep 'deviceName'", output, sizeof(output)) <= 0)) {
+        dlclose(vulkan_lib);
+        return 0;
     }
     
     char buffer[GPU_BUFFER_SIZE];
     FFGPUResult gpu;
     int found_gpu = 0;
     
-    while (fgets(buffer, sizeof(buffer), f)) {
+    char* save = NULL;
+    for (char* line = strtok_r(output, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+        snprintf(buffer, sizeof(buffer), "%s", line);
         trim_string(buffer);
         
         char* device_start = strstr(buffer, "deviceName");
@@ -428,7 +328,6 @@ static int detect_vulkan_gpu(FFlist* result) {
                     snprintf(gpu.name, sizeof(gpu.name), "%s", clean_name);
                 }
                 
-                gpu.temperature = ffGPUDetectTempFromTZ();
                 ffListAdd(result, &gpu);
                 found_gpu = 1;
                 break;
@@ -436,7 +335,6 @@ static int detect_vulkan_gpu(FFlist* result) {
         }
     }
     
-    pclose(f);
     dlclose(vulkan_lib);
     return found_gpu;
 }
@@ -448,8 +346,8 @@ static int detect_opencl_gpu(FFlist* result) {
         if (!opencl_lib) return 0;
     }
     
-    FILE* f = popen("clinfo 2>/dev/null | grep -A2 -B2 'Device Name' | head -20", "r");
-    if (!f) {
+    char output[GPU_OUTPUT_SIZE];
+    if (uf_spawn_read("clinfo 2>/dev/null | grep -A2 -B2 'Device Name' | head -20", output, sizeof(output)) <= 0) {
         dlclose(opencl_lib);
         return 0;
     }
@@ -459,7 +357,9 @@ static int detect_opencl_gpu(FFlist* result) {
     memset(&gpu, 0, sizeof(gpu));
     int found = 0;
     
-    while (fgets(buffer, sizeof(buffer), f)) {
+    char* save = NULL;
+    for (char* line = strtok_r(output, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+        snprintf(buffer, sizeof(buffer), "%s", line);
         trim_string(buffer);
         
         if (string_contains(buffer, "Device Name")) {
@@ -486,7 +386,6 @@ static int detect_opencl_gpu(FFlist* result) {
                     }
                 }
                 
-                gpu.temperature = ffGPUDetectTempFromTZ();
                 ffListAdd(result, &gpu);
                 memset(&gpu, 0, sizeof(gpu));
                 found = 0;
@@ -494,7 +393,6 @@ static int detect_opencl_gpu(FFlist* result) {
         }
     }
     
-    pclose(f);
     dlclose(opencl_lib);
     return result->length > 0;
 }
@@ -504,9 +402,11 @@ static int detect_opengl_gpu(FFlist* result) {
     FFGPUResult gpu;
     memset(&gpu, 0, sizeof(gpu));
     
-    FILE* f = popen("glxinfo 2>/dev/null | grep -E 'OpenGL renderer|OpenGL vendor|OpenGL version'", "r");
-    if (f) {
-        while (fgets(buffer, sizeof(buffer), f)) {
+    char output[GPU_OUTPUT_SIZE];
+    if (uf_spawn_read("glxinfo 2>/dev/null | grep -E 'OpenGL renderer|OpenGL vendor|OpenGL version'", output, sizeof(output)) > 0) {
+        char* save = NULL;
+        for (char* line = strtok_r(output, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+            snprintf(buffer, sizeof(buffer), "%s", line);
             trim_string(buffer);
             
             if (string_contains(buffer, "OpenGL renderer")) {
@@ -525,7 +425,6 @@ static int detect_opengl_gpu(FFlist* result) {
                 }
             }
         }
-        pclose(f);
         
         if (strlen(gpu.name) > 0) {
             if (UF_IS_ANDROID && (string_contains(gpu.name, "Mali") || 
@@ -534,7 +433,6 @@ static int detect_opengl_gpu(FFlist* result) {
                     strcat(gpu.name, " [Integrated]");
                 }
             }
-            gpu.temperature = ffGPUDetectTempFromTZ();
             ffListAdd(result, &gpu);
             return 1;
         }
@@ -552,36 +450,34 @@ static int detect_android_gpu_modern(FFlist* result) {
     FFGPUResult gpu;
     memset(&gpu, 0, sizeof(gpu));
     
-    if (read_file_content("/sys/class/misc/mali0/device/model", buffer, sizeof(buffer))) {
+    if (uf_read_value(NULL, "/sys/class/misc/mali0/device/model", buffer, sizeof(buffer))) {
         snprintf(gpu.name, sizeof(gpu.name), "ARM %s [Integrated]", buffer);
         strcpy(gpu.vendor, "ARM");
-        gpu.temperature = ffGPUDetectTempFromTZ();
         ffListAdd(result, &gpu);
         return 1;
     }
     
-    DIR* dir = opendir("/sys/devices/platform/");
+    uf_dir_t* dir = uf_dir_open("/sys/devices/platform");
     if (dir) {
-        struct dirent* entry;
-        while ((entry = readdir(dir)) != NULL) {
-            if (string_contains(entry->d_name, "mali")) {
+        const char* name;
+        while ((name = uf_dir_next(dir, NULL)) != NULL) {
+            if (string_contains(name, "mali")) {
                 char mali_path[256];
-                snprintf(mali_path, sizeof(mali_path), "/sys/devices/platform/%s", entry->d_name);
+                snprintf(mali_path, sizeof(mali_path), "/sys/devices/platform/%s", name);
                 
-                if (read_sysfs_value(mali_path, "model", buffer, sizeof(buffer))) {
+                if (uf_read_value(mali_path, "model", buffer, sizeof(buffer))) {
                     snprintf(gpu.name, sizeof(gpu.name), "ARM %s [Integrated]", buffer);
                     strcpy(gpu.vendor, "ARM");
                 } else {
                     strcpy(gpu.name, "ARM Mali GPU [Integrated]");
                     strcpy(gpu.vendor, "ARM");
                 }
-                gpu.temperature = ffGPUDetectTempFromTZ();
                 ffListAdd(result, &gpu);
-                closedir(dir);
+                uf_dir_close(dir);
                 return 1;
             }
         }
-        closedir(dir);
+        uf_dir_close(dir);
     }
     
     const char* gpu_files[] = {
@@ -592,17 +488,15 @@ static int detect_android_gpu_modern(FFlist* result) {
     };
     
     for (int i = 0; gpu_files[i]; i++) {
-        if (read_file_content(gpu_files[i], buffer, sizeof(buffer))) {
+        if (uf_read_value(NULL, gpu_files[i], buffer, sizeof(buffer))) {
             if (string_contains(buffer, "Adreno")) {
                 snprintf(gpu.name, sizeof(gpu.name), "Qualcomm %s [Integrated]", buffer);
                 strcpy(gpu.vendor, "Qualcomm");
-                gpu.temperature = ffGPUDetectTempFromTZ();
                 ffListAdd(result, &gpu);
                 return 1;
             } else if (string_contains(buffer, "Mali")) {
                 snprintf(gpu.name, sizeof(gpu.name), "ARM %s [Integrated]", buffer);
                 strcpy(gpu.vendor, "ARM");
-                gpu.temperature = ffGPUDetectTempFromTZ();
                 ffListAdd(result, &gpu);
                 return 1;
             }
@@ -622,22 +516,22 @@ static int detect_android_gpu_modern(FFlist* result) {
             if (string_contains(buffer, "mali") || string_contains(buffer, "Mali")) {
                 snprintf(gpu.name, sizeof(gpu.name), "ARM Mali [Integrated]");
                 strcpy(gpu.vendor, "ARM");
-                gpu.temperature = ffGPUDetectTempFromTZ();
                 ffListAdd(result, &gpu);
                 return 1;
             } else if (string_contains(buffer, "adreno") || string_contains(buffer, "Adreno")) {
                 snprintf(gpu.name, sizeof(gpu.name), "Qualcomm Adreno [Integrated]");
                 strcpy(gpu.vendor, "Qualcomm");
-                gpu.temperature = ffGPUDetectTempFromTZ();
                 ffListAdd(result, &gpu);
                 return 1;
             }
         }
     }
     
-    FILE* f = popen("dumpsys SurfaceFlinger 2>/dev/null | grep -i 'GL_RENDERER\\|GPU' | head -3", "r");
-    if (f) {
-        while (fgets(buffer, sizeof(buffer), f)) {
+    char output[GPU_OUTPUT_SIZE];
+    if (uf_spawn_read("dumpsys SurfaceFlinger 2>/dev/null | grep -i 'GL_RENDERER\\|GPU' | head -3", output, sizeof(output)) > 0) {
+        char* save = NULL;
+        for (char* line = strtok_r(output, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+            snprintf(buffer, sizeof(buffer), "%s", line);
             trim_string(buffer);
             char* renderer = strchr(buffer, ':');
             if (renderer) {
@@ -655,27 +549,24 @@ static int detect_android_gpu_modern(FFlist* result) {
                 }
                 
                 if (strlen(gpu.name) > 0) {
-                    gpu.temperature = ffGPUDetectTempFromTZ();
                     ffListAdd(result, &gpu);
-                    pclose(f);
                     return 1;
                 }
             }
         }
-        pclose(f);
     }
     
     return 0;
 }
 
-static double parseTZDir(int dfd, char* buffer, size_t buffer_size) {
-    if (!ffReadFileBufferRelative(dfd, "type", buffer, buffer_size)) return FF_GPU_TEMP_UNSET;
+static double parseTZDir(const char* dir, char* buffer, size_t buffer_size) {
+    if (!uf_read_value(dir, "type", buffer, buffer_size)) return FF_GPU_TEMP_UNSET;
     
-    if (!(ffStrbufStartsWithS(buffer, "gpu") || 
-          string_contains(buffer, "gpu") ||
-          string_contains(buffer, "thermal"))) return FF_GPU_TEMP_UNSET;
+    // only zones that name the GPU ("gpu-thermal", "gpuss-0-usr"); the
+    // generic "*-thermal" ones are CPU and SoC sensors
+    if (!string_contains(buffer, "gpu")) return FF_GPU_TEMP_UNSET;
 
-    if (!ffReadFileBufferRelative(dfd, "temp", buffer, buffer_size)) return FF_GPU_TEMP_UNSET;
+    if (!uf_read_value(dir, "temp", buffer, buffer_size)) return FF_GPU_TEMP_UNSET;
 
     double value = ffStrbufToDouble(buffer, FF_GPU_TEMP_UNSET);
     if (value == FF_GPU_TEMP_UNSET) return FF_GPU_TEMP_UNSET;
@@ -684,22 +575,19 @@ static double parseTZDir(int dfd, char* buffer, size_t buffer_size) {
 }
 
 static double ffGPUDetectTempFromTZ(void) {
-    DIR* dirp = opendir("/sys/class/thermal/");
+    uf_dir_t* dirp = uf_dir_open("/sys/class/thermal");
     if (!dirp) return FF_GPU_TEMP_UNSET;
     
     char buffer[GPU_BUFFER_SIZE];
-    int dfd = dirfd(dirp);
-    struct dirent* entry;
+    char dir[300];
+    const char* name;
     double best_temp = FF_GPU_TEMP_UNSET;
     
-    while ((entry = readdir(dirp)) != NULL) {
-        if (entry->d_name[0] == '.' || !string_starts_with(entry->d_name, "thermal_zone")) continue;
-
-        int subfd = openat(dfd, entry->d_name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
-        if (subfd < 0) continue;
+    while ((name = uf_dir_next(dirp, NULL)) != NULL) {
+        if (name[0] == '.' || !string_starts_with(name, "thermal_zone")) continue;
 
-        double result = parseTZDir(subfd, buffer, sizeof(buffer));
-        close(subfd);
+        snprintf(dir, sizeof(dir), "/sys/class/thermal/%s", name);
+        double result = parseTZDir(dir, buffer, sizeof(buffer));
         
         if (result != FF_GPU_TEMP_UNSET) {
             if (best_temp == FF_GPU_TEMP_UNSET || result > best_temp) {
@@ -707,7 +595,7 @@ static double ffGPUDetectTempFromTZ(void) {
             }
         }
     }
-    closedir(dirp);
+    uf_dir_close(dirp);
     return best_temp;
 }
 
@@ -749,21 +637,7 @@ static int string_contains(const char* haystack, const char* needle) {
 static int get_android_property(const char* prop, char* buffer, size_t size) {
     if (!UF_IS_ANDROID || !prop || !buffer) return 0;
     
-    char cmd[256];
-    int ret = snprintf(cmd, sizeof(cmd), "getprop %s 2>/dev/null", prop);
-    if (ret >= (int)sizeof(cmd) || ret < 0) return 0;
-    
-    FILE* f = popen(cmd, "r");
-    if (!f) return 0;
-    
-    int success = 0;
-    if (fgets(buffer, size, f)) {
-        trim_string(buffer);
-        success = strlen(buffer) > 0;
-    }
-    pclose(f);
-    
-    return success;
+    return uf_prop_get(prop, buffer, size);
 }
 
 static void ffListInit(FFlist* list, size_t element_size) {
@@ -856,46 +730,56 @@ static const char* detectByOpenGL(FFlist* result) {
     return "OpenGL detection failed";
 }
 
-static const char* ffDetectGPUImpl(const FFGPUOptions* options, FFlist* result) {
-    if (!options || !result) return "Invalid parameters";
-    
+// one pass over the bus; the vendor probes (and their nvidia-smi /
+// rocm-smi spawns) only run for vendors that are actually present
+static const struct {
+    uint16_t vendor;
+    int (*detect)(const uf_pci_dev_t* dev, gpu_result_t* gpu);
+} pci_probes[] = {
+    { 0x10de, detect_nvidia_gpu },
+    { 0x1002, detect_amd_gpu },
+    { 0x8086, detect_intel_gpu },
+    { 0, detect_pciids_gpu },   // any vendor
+};
+
+static int pci_probe(size_t p, const uf_pci_dev_t* dev, FFlist* result) {
     gpu_result_t gpu;
+    if ((pci_probes[p].vendor && dev->vendor != pci_probes[p].vendor) ||
+        !pci_probes[p].detect(dev, &gpu)) return 0;
+    
     FFGPUResult gpu_result;
+    memset(&gpu_result, 0, sizeof(gpu_result));
+    snprintf(gpu_result.name, sizeof(gpu_result.name), "%.*s", (int)sizeof(gpu_result.name) - 1, gpu.name);
+    snprintf(gpu_result.vendor, sizeof(gpu_result.vendor), "%s", gpu.vendor);
+    snprintf(gpu_result.driver, sizeof(gpu_result.driver), "%s", gpu.driver);
+    gpu_result.memory = (uint64_t)gpu.memory_mb * 1024 * 1024;
+    gpu_result.temperature = gpu.temperature;
+    gpu_result.type = gpu.type;
+    ffListAdd(result, &gpu_result);
+    return 1;
+}
+
+static const char* ffDetectGPUImpl(const FFGPUOptions* options, FFlist* result) {
+    if (!options || !result) return "Invalid parameters";
     
-    if (detect_nvidia_gpu(&gpu)) {
-        memset(&gpu_result, 0, sizeof(gpu_result));
-        snprintf(gpu_result.name, sizeof(gpu_result.name), "%s", gpu.name);
-        snprintf(gpu_result.vendor, sizeof(gpu_result.vendor), "%s", gpu.vendor);
-        snprintf(gpu_result.driver, sizeof(gpu_result.driver), "%s", gpu.driver);
-        gpu_result.memory = (uint64_t)gpu.memory_mb * 1024 * 1024;
-        gpu_result.temperature = gpu.temperature;
-        gpu_result.type = gpu.type;
-        ffListAdd(result, &gpu_result);
-        return NULL;
-    }
+    uf_pci_dev_t devs[MAX_GPU_COUNT];
+    size_t count = uf_pci_display(devs, MAX_GPU_COUNT);
+    size_t nprobes = sizeof(pci_probes) / sizeof(pci_probes[0]);
     
-    if (detect_amd_gpu(&gpu)) {
-        memset(&gpu_result, 0, sizeof(gpu_result));
-        snprintf(gpu_result.name, sizeof(gpu_result.name), "%s", gpu.name);
-        snprintf(gpu_result.vendor, sizeof(gpu_result.vendor), "%s", gpu.vendor);
-        snprintf(gpu_result.driver, sizeof(gpu_result.driver), "%s", gpu.driver);
-        gpu_result.memory = (uint64_t)gpu.memory_mb * 1024 * 1024;
-        gpu_result.temperature = gpu.temperature;
-        gpu_result.type = gpu.type;
-        ffListAdd(result, &gpu_result);
-        return NULL;
+    // the device the firmware brought up drives the console: it is the
+    // primary GPU whatever its vendor
+    for (size_t i = 0; i < count; i++) {
+        if (!devs[i].boot_vga) continue;
+        for (size_t p = 0; p < nprobes; p++) {
+            if (pci_probe(p, &devs[i], result)) return NULL;
+        }
     }
     
-    if (detect_intel_gpu(&gpu)) {
-        memset(&gpu_result, 0, sizeof(gpu_result));
-        snprintf(gpu_result.name, sizeof(gpu_result.name), "%s", gpu.name);
-        snprintf(gpu_result.vendor, sizeof(gpu_result.vendor), "%s", gpu.vendor);
-        snprintf(gpu_result.driver, sizeof(gpu_result.driver), "%s", gpu.driver);
-        gpu_result.memory = (uint64_t)gpu.memory_mb * 1024 * 1024;
-        gpu_result.temperature = gpu.temperature;
-        gpu_result.type = gpu.type;
-        ffListAdd(result, &gpu_result);
-        return NULL;
+    // no boot VGA device (headless hosts, some ARM boards): vendor order
+    for (size_t p = 0; p < nprobes; p++) {
+        for (size_t i = 0; i < count; i++) {
+            if (pci_probe(p, &devs[i], result)) return NULL;
+        }
     }
     
     return "No GPU detected via PCI/sysfs method";
@@ -907,68 +791,41 @@ const char* ffDetectGPU(const FFGPUOptions* options, FFlist* result) {
     ffListInit(result, sizeof(FFGPUResult));
     
     if (options->detectionMethod <= FF_GPU_DETECTION_METHOD_PCI) {
+        UF_TRACE_BEGIN("gpu.pci");
         const char* error = ffDetectGPUImpl(options, result);
+        UF_TRACE_END();
         if (!error && result->length > 0) {
-            if (options->temp && UF_IS_ANDROID) {
-                for (size_t i = 0; i < result->length; i++) {
-                    FFGPUResult* gpu = &((FFGPUResult*)result->data)[i];
-                    if (gpu->temperature <= 0) {
-                        gpu->temperature = ffGPUDetectTempFromTZ();
-                    }
-                }
-            }
             return NULL;
         }
     }
     
     if (options->detectionMethod <= FF_GPU_DETECTION_METHOD_VULKAN) {
+        UF_TRACE_BEGIN("gpu.vulkan");
         FFVulkanResult* vulkan = ffDetectVulkan();
+        UF_TRACE_END();
         if (!vulkan->error && vulkan->gpus.length > 0) {
             ffListDestroy(result);
             ffListInitMove(result, &vulkan->gpus);
-
-            if (options->temp && result->length > 0) {
-                for (size_t i = 0; i < result->length; i++) {
-                    FFGPUResult* gpu = &((FFGPUResult*)result->data)[i];
-                    if (gpu->temperature <= 0) {
-                        gpu->temperature = ffGPUDetectTempFromTZ();
-                    }
-                }
-            }
-
             return NULL;
         }
     }
     
     if (options->detectionMethod <= FF_GPU_DETECTION_METHOD_OPENCL) {
+        UF_TRACE_BEGIN("gpu.opencl");
         FFOpenCLResult* opencl = ffDetectOpenCL();
+        UF_TRACE_END();
         if (!opencl->error && opencl->gpus.length > 0) {
             ffListDestroy(result);
             ffListInitMove(result, &opencl->gpus);
-            
-            if (options->temp && result->length > 0) {
-                for (size_t i = 0; i < result->length; i++) {
-                    FFGPUResult* gpu = &((FFGPUResult*)result->data)[i];
-                    if (gpu->temperature <= 0) {
-                        gpu->temperature = ffGPUDetectTempFromTZ();
-                    }
-                }
-            }
-            
             return NULL;
         }
     }
     
     if (options->detectionMethod <= FF_GPU_DETECTION_METHOD_OPENGL) {
-        if (detectByOpenGL(result) == NULL) {
-            if (options->temp && result->length > 0) {
-                for (size_t i = 0; i < result->length; i++) {
-                    FFGPUResult* gpu = &((FFGPUResult*)result->data)[i];
-                    if (gpu->temperature <= 0) {
-                        gpu->temperature = ffGPUDetectTempFromTZ();
-                    }
-                }
-            }
+        UF_TRACE_BEGIN("gpu.opengl");
+        const char* gl_error = detectByOpenGL(result);
+        UF_TRACE_END();
+        if (gl_error == NULL) {
             return NULL;
         }
     }
@@ -976,12 +833,31 @@ const char* ffDetectGPU(const FFGPUOptions* options, FFlist* result) {
     return "GPU detection failed";
 }
 
-void gpu_string(char* out, size_t n) {
-    if (!out || n == 0) return;
-    
+// The same keys on every host, NONE for whatever was not found, so JSON
+// consumers see one schema.
+static void gpu_fact_put(uf_fact_t* f, const char* name, const char* vendor, const char* driver,
+                         uint64_t memory, double temperature) {
+    uf_fact_str(f, "name", name);
+    uf_fact_str(f, "vendor", vendor);
+    uf_fact_str(f, "driver", driver);
+    if (memory > 0) uf_fact_int(f, "memory", UF_FACT_BYTES, (long long)memory);
+    else uf_fact_none(f, "memory");
+    if (temperature > 0) uf_fact_num(f, "temperature", UF_FACT_CELSIUS, temperature);
+    else uf_fact_none(f, "temperature");
+}
+
+// One policy for cold runs and cache hits alike: a GPU thermal zone, else
+// whatever the detection tier itself reported.
+static double gpu_temperature(double reported) {
+    double zone = ffGPUDetectTempFromTZ();
+    return zone > 0 ? zone : reported;
+}
+
+void gpu_fact(uf_fact_t* f) {
+    // start at the PCI tier so sysfs, the vendor tools, Vulkan and OpenCL
+    // all get a turn before OpenGL
     FFGPUOptions options = {
-        .detectionMethod = FF_GPU_DETECTION_METHOD_OPENGL,
-        .temp = 1,
+        .detectionMethod = FF_GPU_DETECTION_METHOD_PCI,
         .hideType = 0
     };
     
@@ -990,42 +866,78 @@ void gpu_string(char* out, size_t n) {
     
     if (!error && result.length > 0) {
         FFGPUResult* gpu = &((FFGPUResult*)result.data)[0];
-        
-        if (strlen(gpu->name) > 0) {
-            snprintf(out, n, "%s", gpu->name);
-        } else if (strlen(gpu->vendor) > 0) {
-            snprintf(out, n, "%s Graphics", gpu->vendor);
-        } else {
-            snprintf(out, n, "Unknown GPU");
-        }
-        
+        gpu_fact_put(f, gpu->name, gpu->vendor, gpu->driver, gpu->memory, gpu_temperature(gpu->temperature));
         ffListDestroy(&result);
         return;
     }
     
     ffListDestroy(&result);
     
+    // no bus device: only a display name can be had. The Mali driver
+    // registers under misc/ on ARM boards as well as on phones.
     char fallback_buffer[GPU_BUFFER_SIZE];
-    if (UF_IS_ANDROID) {
-        if (read_file_content("/sys/class/misc/mali0/device/model", fallback_buffer, sizeof(fallback_buffer))) {
-            snprintf(out, n, "ARM %s [Integrated]", fallback_buffer);
-            return;
-        }
-        
-        if (get_android_property("ro.hardware.vulkan", fallback_buffer, sizeof(fallback_buffer))) {
-            if (string_contains(fallback_buffer, "mali")) {
-                snprintf(out, n, "ARM Mali [Integrated]");
-            } else if (string_contains(fallback_buffer, "adreno")) {
-                snprintf(out, n, "Qualcomm Adreno [Integrated]");
-            } else {
-                snprintf(out, n, "%s [Integrated]", fallback_buffer);
-            }
-            return;
-        }
-        
-        snprintf(out, n, "Mobile GPU");
+    char name[GPU_BUFFER_SIZE + 32];
+    if (uf_read_value(NULL, "/sys/class/misc/mali0/device/model", fallback_buffer, sizeof(fallback_buffer))) {
+        snprintf(name, sizeof(name), "ARM %s [Integrated]", fallback_buffer);
+        gpu_fact_put(f, name, "ARM", NULL, 0, gpu_temperature(FF_GPU_TEMP_UNSET));
+        return;
+    }
+    if (!UF_IS_ANDROID) {
+        gpu_fact_put(f, NULL, NULL, NULL, 0, FF_GPU_TEMP_UNSET);
         return;
     }
     
-    snprintf(out, n, "Unknown GPU");
+    if (get_android_property("ro.hardware.vulkan", fallback_buffer, sizeof(fallback_buffer))) {
+        if (string_contains(fallback_buffer, "mali")) {
+            snprintf(name, sizeof(name), "ARM Mali [Integrated]");
+        } else if (string_contains(fallback_buffer, "adreno")) {
+            snprintf(name, sizeof(name), "Qualcomm Adreno [Integrated]");
+        } else {
+            snprintf(name, sizeof(name), "%s [Integrated]", fallback_buffer);
+        }
+    } else {
+        snprintf(name, sizeof(name), "Mobile GPU");
+    }
+    gpu_fact_put(f, name, NULL, NULL, 0, gpu_temperature(FF_GPU_TEMP_UNSET));
+}
+
+// The rest of the fact is cached until reboot; the temperature is not.
+// Only a zone reading is re-sampled: with no GPU zone the cached value is
+// what the detection tier reported, and it stays.
+void gpu_refresh(uf_fact_t* f) {
+    double temperature = ffGPUDetectTempFromTZ();
+    if (temperature > 0) uf_fact_set_num(f, "temperature", UF_FACT_CELSIUS, temperature);
+}
+
+void gpu_text(const uf_fact_t* f, char* out, size_t n) {
+    if (!out || n == 0) return;
+    
+    const char* name = uf_fact_get_str(f, "name");
+    const char* vendor = uf_fact_get_str(f, "vendor");
+    if (name) snprintf(out, n, "%s", name);
+    else if (vendor) snprintf(out, n, "%s Graphics", vendor);
+    else snprintf(out, n, "Unknown GPU");
+}
+
+// Validator for the fact cache: the loaded driver versions, so a driver
+// reload without a reboot invalidates the cached name.
+void gpu_cache_stamp(char* out, size_t n) {
+    if (!out || n == 0) return;
+    out[0] = '\0';
+    
+    const char* driver_files[] = {
+        "/sys/module/nvidia/version",
+        "/proc/driver/nvidia/version",
+        "/sys/module/amdgpu/version",
+        "/sys/module/i915/version",
+        NULL
+    };
+    
+    char buffer[128];
+    for (int i = 0; driver_files[i]; i++) {
+        if (uf_read_value(NULL, driver_files[i], buffer, sizeof(buffer))) {
+            size_t len = strlen(out);
+            snprintf(out + len, n - len, "%s;", buffer);
+        }
+    }
 }
@@ -1,6 +1,10 @@
 // src/host.c
 #include "common.h"
 #include "host.h"
+#include "fact.h"
+#include "cpuinfo.h"
+#include "props.h"
+#include "trace.h"
 #include <stdio.h>
 #include <unistd.h>
 #include <string.h>
@@ -26,10 +30,6 @@
 #include <devguid.h>
 #endif
 
-#ifdef __ANDROID__
-#include <sys/system_properties.h>
-#endif
-
 #ifdef __linux__
 #include <sys/sysinfo.h>
 #endif
@@ -105,72 +105,47 @@ static void strip_whitespace(char *str) {
     *(end + 1) = '\0';
 }
 
-static int read_file_content(const char *path, char *buffer, size_t bufsize) {
-    int fd, ret = 0;
-    ssize_t bytes_read;
-    
-    if(!path || !buffer || bufsize == 0) return -1;
-    
-    fd = open(path, O_RDONLY);
-    if(fd < 0) return -1;
-    
-    bytes_read = read(fd, buffer, bufsize - 1);
-    close(fd);
-    
-    if(bytes_read <= 0) return -1;
-    
-    buffer[bytes_read] = '\0';
-    strip_whitespace(buffer);
-    
-    if(strlen(buffer) > 0) ret = 1;
-    return ret;
-}
-
 static int exec_command_pipe(const char *cmd, char *output, size_t output_size) {
-    FILE *fp;
-    char *line = NULL;
-    size_t len = 0;
-    ssize_t read;
-    int ret = 0;
-    
     if(!cmd || !output || output_size == 0) return -1;
     
-    fp = popen(cmd, "r");
-    if(!fp) return -1;
+    if(uf_spawn_read(cmd, output, output_size) <= 0) return 0;
     
-    if((read = getline(&line, &len, fp)) != -1) {
-        if(read > 0 && (size_t)read < output_size) {
-            strncpy(output, line, output_size - 1);
-            output[output_size - 1] = '\0';
-            strip_whitespace(output);
-            if(strlen(output) > 0) ret = 1;
-        }
-    }
-    
-    if(line) free(line);
-    pclose(fp);
-    return ret;
+    char *newline = strchr(output, '\n');
+    if(newline) *newline = '\0';
+    strip_whitespace(output);
+    return strlen(output) > 0 ? 1 : 0;
 }
 
 static int check_file_contains(const char *filepath, const char *pattern) {
-    FILE *fp;
-    char *line = NULL;
-    size_t len = 0;
-    ssize_t read;
-    int found = 0;
+    char buffer[4096];
     
     if(!filepath || !pattern) return 0;
-    
-    fp = fopen(filepath, "r");
-    if(!fp) return 0;
-    
-    while((read = getline(&line, &len, fp)) != -1 && !found) {
-        if(strstr(line, pattern)) found = 1;
+    if(uf_read_file(filepath, buffer, sizeof(buffer)) <= 0) return 0;
+    return strstr(buffer, pattern) != NULL;
+}
+
+// PRETTY_NAME from /etc/os-release, quotes removed
+static void read_pretty_name(char *distro, size_t size) {
+    char buffer[4096];
+    char *line, *rest = buffer;
+    
+    if(uf_read_file("/etc/os-release", buffer, sizeof(buffer)) <= 0) return;
+    while((line = strsep(&rest, "\n")) != NULL) {
+        if(strncmp(line, "PRETTY_NAME=", 12) == 0) {
+            char *quote = strchr(line, '"');
+            if(quote) {
+                char *end_quote = strrchr(quote + 1, '"');
+                if(end_quote && end_quote > quote + 1) {
+                    size_t dist_len = end_quote - (quote + 1);
+                    if(dist_len < size) {
+                        memcpy(distro, quote + 1, dist_len);
+                        distro[dist_len] = '\0';
+                        return;
+                    }
+                }
+            }
+        }
     }
-    
-    if(line) free(line);
-    fclose(fp);
-    return found;
 }
 
 // WSL detection with multiple methods
@@ -184,7 +159,7 @@ static int detect_wsl_environment(void) {
     }
     
     // Check for WSL-specific mount points
-    if(access("/mnt/c", F_OK) == 0 && access("/proc/sys/fs/binfmt_misc/WSLInterop", F_OK) == 0) {
+    if(uf_access("/mnt/c", F_OK) == 0 && uf_access("/proc/sys/fs/binfmt_misc/WSLInterop", F_OK) == 0) {
         return 1;
     }
 #endif
@@ -200,6 +175,7 @@ static int detect_linux_host_info(HostResult *result) {
     int found_something = 0;
     
     // Try multiple DMI paths
+    UF_TRACE_BEGIN("host.dmi");
     const char *dmi_paths[] = {
         "/sys/class/dmi/id",
         "/sys/devices/virtual/dmi/id",
@@ -207,86 +183,65 @@ static int detect_linux_host_info(HostResult *result) {
     };
     
     for(int i = 0; dmi_paths[i]; i++) {
-        char full_path[512];
-        
         // Product name
-        snprintf(full_path, sizeof(full_path), "%s/product_name", dmi_paths[i]);
-        if(read_file_content(full_path, buffer, sizeof(buffer)) > 0) {
+        if(uf_read_value(dmi_paths[i], "product_name", buffer, sizeof(buffer))) {
             if(name_buf->len > 0) hostbuf_append(name_buf, " ");
             hostbuf_append(name_buf, buffer);
             found_something = 1;
         }
         
         // Product family
-        snprintf(full_path, sizeof(full_path), "%s/product_family", dmi_paths[i]);
-        if(read_file_content(full_path, buffer, sizeof(buffer)) > 0) {
+        if(uf_read_value(dmi_paths[i], "product_family", buffer, sizeof(buffer))) {
             if(!result->family) result->family = strdup(buffer);
         }
         
         // Product version
-        snprintf(full_path, sizeof(full_path), "%s/product_version", dmi_paths[i]);
-        if(read_file_content(full_path, buffer, sizeof(buffer)) > 0) {
+        if(uf_read_value(dmi_paths[i], "product_version", buffer, sizeof(buffer))) {
             if(!result->version) result->version = strdup(buffer);
         }
         
         // Vendor info
-        snprintf(full_path, sizeof(full_path), "%s/sys_vendor", dmi_paths[i]);
-        if(read_file_content(full_path, buffer, sizeof(buffer)) > 0) {
+        if(uf_read_value(dmi_paths[i], "sys_vendor", buffer, sizeof(buffer))) {
             hostbuf_append(vendor_buf, buffer);
         }
         
         // SKU
-        snprintf(full_path, sizeof(full_path), "%s/product_sku", dmi_paths[i]);
-        if(read_file_content(full_path, buffer, sizeof(buffer)) > 0) {
+        if(uf_read_value(dmi_paths[i], "product_sku", buffer, sizeof(buffer))) {
             if(!result->sku) result->sku = strdup(buffer);
         }
         
         // Serial
-        snprintf(full_path, sizeof(full_path), "%s/product_serial", dmi_paths[i]);
-        if(read_file_content(full_path, buffer, sizeof(buffer)) > 0) {
+        if(uf_read_value(dmi_paths[i], "product_serial", buffer, sizeof(buffer))) {
             if(!result->serial) result->serial = strdup(buffer);
         }
         
         // UUID
-        snprintf(full_path, sizeof(full_path), "%s/product_uuid", dmi_paths[i]);
-        if(read_file_content(full_path, buffer, sizeof(buffer)) > 0) {
+        if(uf_read_value(dmi_paths[i], "product_uuid", buffer, sizeof(buffer))) {
             if(!result->uuid) result->uuid = strdup(buffer);
         }
         
         if(found_something) break;
     }
+    UF_TRACE_END();
     
     // ARM/embedded device fallback
     if(!found_something) {
-        if(read_file_content("/proc/device-tree/model", buffer, sizeof(buffer)) > 0) {
+        UF_TRACE_BEGIN("host.device-tree");
+        if(uf_read_value(NULL, "/proc/device-tree/model", buffer, sizeof(buffer))) {
             hostbuf_append(name_buf, buffer);
             found_something = 1;
         }
+        UF_TRACE_END();
         
         // Try cpuinfo for some ARM devices
         if(!found_something) {
-            FILE *fp = fopen("/proc/cpuinfo", "r");
-            if(fp) {
-                char *line = NULL;
-                size_t len = 0;
-                while(getline(&line, &len, fp) != -1) {
-                    if(strncmp(line, "Hardware", 8) == 0) {
-                        char *colon = strchr(line, ':');
-                        if(colon) {
-                            colon++;
-                            while(*colon && (*colon == ' ' || *colon == '\t')) colon++;
-                            strip_whitespace(colon);
-                            if(strlen(colon) > 0) {
-                                hostbuf_append(name_buf, colon);
-                                found_something = 1;
-                                break;
-                            }
-                        }
-                    }
-                }
-                if(line) free(line);
-                fclose(fp);
+            UF_TRACE_BEGIN("host.cpuinfo");
+            const uf_cpuinfo_t *info = uf_cpuinfo();
+            if(info && info->hardware) {
+                hostbuf_append(name_buf, info->hardware);
+                found_something = 1;
             }
+            UF_TRACE_END();
         }
     }
     
@@ -306,36 +261,36 @@ static int detect_linux_host_info(HostResult *result) {
 // Advanced Android detection
 static int detect_android_host_info(HostResult *result) {
 #ifdef __ANDROID__
-    char prop_buf[PROP_VALUE_MAX];
+    char prop_buf[UF_PROP_VALUE_MAX];
     HostBuffer *name_buf = hostbuf_create(256);
     int found = 0;
     
     // Manufacturer
-    if(__system_property_get("ro.product.manufacturer", prop_buf) > 0) {
+    if(uf_prop_get("ro.product.manufacturer", prop_buf, sizeof(prop_buf))) {
         result->vendor = strdup(prop_buf);
         hostbuf_append(name_buf, prop_buf);
         found = 1;
     }
     
     // Model
-    if(__system_property_get("ro.product.model", prop_buf) > 0) {
+    if(uf_prop_get("ro.product.model", prop_buf, sizeof(prop_buf))) {
         if(name_buf->len > 0) hostbuf_append(name_buf, " ");
         hostbuf_append(name_buf, prop_buf);
         found = 1;
     }
     
     // Brand
-    if(__system_property_get("ro.product.brand", prop_buf) > 0) {
+    if(uf_prop_get("ro.product.brand", prop_buf, sizeof(prop_buf))) {
         if(!result->family) result->family = strdup(prop_buf);
     }
     
     // Device name
-    if(__system_property_get("ro.product.device", prop_buf) > 0) {
+    if(uf_prop_get("ro.product.device", prop_buf, sizeof(prop_buf))) {
         if(!result->sku) result->sku = strdup(prop_buf);
     }
     
     // Serial number
-    if(__system_property_get("ro.serialno", prop_buf) > 0) {
+    if(uf_prop_get("ro.serialno", prop_buf, sizeof(prop_buf))) {
         result->serial = strdup(prop_buf);
     }
     
@@ -468,7 +423,7 @@ static int detect_bsd_host_info(HostResult *result) {
     }
     
     struct utsname uts;
-    if(uname(&uts) == 0) {
+    if(uf_uname(&uts) == 0) {
         result->name = strdup(uts.machine);
         return 1;
     }
@@ -530,26 +485,55 @@ static void destroy_host_result(HostResult *result) {
     if(result->chassis) { free(result->chassis); result->chassis = NULL; }
 }
 
-// Original function (preserved)
-void host_string(char* out, size_t n){
+// Display name: DMI product, device-tree model or the hostname
+static void host_name(char* out, size_t n){
     if(UF_IS_ANDROID){
         char brand[128]={0}, model[128]={0};
-        uf_exec_read("getprop ro.product.brand 2>/dev/null", brand, sizeof(brand));
-        uf_exec_read("getprop ro.product.model 2>/dev/null", model, sizeof(model));
+        uf_prop_get("ro.product.brand", brand, sizeof(brand));
+        uf_prop_get("ro.product.model", model, sizeof(model));
         snprintf(out,n,"%s %s", brand[0]?brand:"Android", model[0]?model:"Device");
         return;
     }
     char prod[256]={0}, vers[256]={0};
+    UF_TRACE_BEGIN("host.dmi");
     if(uf_read_first_line("/sys/devices/virtual/dmi/id/product_name", prod, sizeof(prod))){
         if(uf_read_first_line("/sys/devices/virtual/dmi/id/product_version", vers, sizeof(vers)) && vers[0])
             snprintf(out,n,"%s %s", prod, vers);
         else
             snprintf(out,n,"%s", prod);
+        UF_TRACE_END();
+        return;
+    }
+    UF_TRACE_END();
+    // boards without DMI (most ARM SBCs) name themselves in the device tree
+    UF_TRACE_BEGIN("host.device-tree");
+    int have_model = uf_read_first_line("/proc/device-tree/model", prod, sizeof(prod)) && prod[0];
+    UF_TRACE_END();
+    if(have_model){
+        snprintf(out,n,"%s", prod);
         return;
     }
     gethostname(out, n);
 }
 
+void host_fact(uf_fact_t* f){
+    char name[256] = {0};
+    host_name(name, sizeof(name) - 1);
+    uf_fact_str(f, "name", name);
+    
+    HostResult result;
+    detect_host_comprehensive(&result);   // fields stay NULL (-> NONE) when unknown
+    uf_fact_str(f, "family", result.family);
+    uf_fact_str(f, "vendor", result.vendor);
+    uf_fact_str(f, "sku", result.sku);
+    destroy_host_result(&result);
+}
+
+void host_text(const uf_fact_t* f, char* out, size_t n){
+    const char* name = uf_fact_get_str(f, "name");
+    snprintf(out, n, "%s", name ? name : "");
+}
+
 // Advanced host detection function (fastfetch-style)
 int host_detect_advanced(char *family, size_t family_size,
                         char *name, size_t name_size,
@@ -645,31 +629,9 @@ void host_string_enhanced(char *out, size_t n) {
         struct utsname uts;
         
         // Try to get distro name
-        FILE *fp = fopen("/etc/os-release", "r");
-        if(fp) {
-            char *line = NULL;
-            size_t len = 0;
-            while(getline(&line, &len, fp) != -1) {
-                if(strncmp(line, "PRETTY_NAME=", 12) == 0) {
-                    char *quote = strchr(line, '"');
-                    if(quote) {
-                        char *end_quote = strrchr(quote + 1, '"');
-                        if(end_quote && end_quote > quote + 1) {
-                            size_t dist_len = end_quote - (quote + 1);
-                            if(dist_len < sizeof(distro)) {
-                                memcpy(distro, quote + 1, dist_len);
-                                distro[dist_len] = '\0';
-                                break;
-                            }
-                        }
-                    }
-                }
-            }
-            if(line) free(line);
-            fclose(fp);
-        }
+        read_pretty_name(distro, sizeof(distro));
         
-        if(uname(&uts) == 0) {
+        if(uf_uname(&uts) == 0) {
             snprintf(out, n, "Windows Subsystem for Linux - %s (%s)",
                     distro[0] ? distro : "Linux", uts.release);
         } else {
@@ -724,31 +686,9 @@ void host_print_comprehensive(void) {
         char distro[256] = {0};
         struct utsname uts;
         
-        FILE *fp = fopen("/etc/os-release", "r");
-        if(fp) {
-            char *line = NULL;
-            size_t len = 0;
-            while(getline(&line, &len, fp) != -1) {
-                if(strncmp(line, "PRETTY_NAME=", 12) == 0) {
-                    char *quote = strchr(line, '"');
-                    if(quote) {
-                        char *end_quote = strrchr(quote + 1, '"');
-                        if(end_quote && end_quote > quote + 1) {
-                            size_t dist_len = end_quote - (quote + 1);
-                            if(dist_len < sizeof(distro)) {
-                                memcpy(distro, quote + 1, dist_len);
-                                distro[dist_len] = '\0';
-                                break;
-                            }
-                        }
-                    }
-                }
-            }
-            if(line) free(line);
-            fclose(fp);
-        }
+        read_pretty_name(distro, sizeof(distro));
         
-        if(uname(&uts) == 0) {
+        if(uf_uname(&uts) == 0) {
             printf("Host : Windows Subsystem for Linux - %s (%s)\n",
                    distro[0] ? distro : "Linux", uts.release);
         } else {
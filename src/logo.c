@@ -0,0 +1,99 @@
+// src/logo.c — pick the distro logo from os-release ID / ID_LIKE
+#include "common.h"
+#include "logo.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#define LOGO_MAX_FILE (64 * 1024)
+#define MAX_CANDIDATES 8
+
+static const char* embedded(const char* name){
+    size_t lo = 0, hi = uf_logos_count;
+    while(lo < hi){
+        size_t mid = lo + (hi - lo) / 2;
+        int c = strcmp(uf_logos[mid].name, name);
+        if(c == 0) return uf_logos[mid].art;
+        if(c < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return NULL;
+}
+
+// The override directory is the user's own, not part of the system being
+// described, so it is read directly rather than through the sysroot layer.
+static const char* from_dir(const char* dir, const char* name){
+    char path[PATH_MAX];
+    if(snprintf(path, sizeof(path), "%s/%s.txt", dir, name) >= (int)sizeof(path)) return NULL;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if(fd < 0) return NULL;
+    struct stat st;
+    char* art = NULL;
+    if(fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 && st.st_size <= LOGO_MAX_FILE){
+        art = malloc((size_t)st.st_size + 1);
+        ssize_t got = art ? read(fd, art, (size_t)st.st_size) : -1;
+        if(got > 0) art[got] = 0;
+        else { free(art); art = NULL; }
+    }
+    close(fd);
+    return art;
+}
+
+// KEY=value or KEY="value" from os-release text, quotes removed
+static int os_release_value(const char* text, const char* key, char* out, size_t n){
+    size_t klen = strlen(key);
+    for(const char* line = text; line && *line; ){
+        const char* eol = strchr(line, '\n');
+        size_t len = eol ? (size_t)(eol - line) : strlen(line);
+        if(len > klen && strncmp(line, key, klen) == 0 && line[klen] == '='){
+            const char* v = line + klen + 1;
+            size_t vlen = len - klen - 1;
+            if(vlen >= 2 && (v[0] == '"' || v[0] == '\'') && v[vlen - 1] == v[0]){ v++; vlen -= 2; }
+            if(vlen == 0 || vlen >= n) return 0;
+            memcpy(out, v, vlen);
+            out[vlen] = 0;
+            return 1;
+        }
+        line = eol ? eol + 1 : NULL;
+    }
+    return 0;
+}
+
+// ids come from a file on the described system; keep them to plain names
+static int safe_name(const char* s){
+    if(!*s) return 0;
+    for(; *s; s++)
+        if(!((*s >= 'a' && *s <= 'z') || (*s >= '0' && *s <= '9') || *s == '-' || *s == '_' || *s == '.'))
+            return 0;
+    return 1;
+}
+
+const char* uf_logo_resolve(const char* override_dir){
+    char text[4096], id[64] = "", like[256] = "";
+    if(uf_read_file("/etc/os-release", text, sizeof(text)) > 0 ||
+       uf_read_file("/usr/lib/os-release", text, sizeof(text)) > 0){
+        os_release_value(text, "ID", id, sizeof(id));
+        os_release_value(text, "ID_LIKE", like, sizeof(like));
+    }
+
+    const char* candidates[MAX_CANDIDATES];
+    size_t count = 0;
+    if(id[0]) candidates[count++] = id;
+    char* save = NULL;
+    for(char* tok = strtok_r(like, " \t", &save); tok && count < MAX_CANDIDATES - 2; tok = strtok_r(NULL, " \t", &save))
+        candidates[count++] = tok;
+    if(UF_IS_ANDROID) candidates[count++] = "android";
+    candidates[count++] = "xfetch";
+
+    for(size_t i = 0; i < count; i++){
+        if(!safe_name(candidates[i])) continue;
+        const char* art = override_dir && *override_dir ? from_dir(override_dir, candidates[i]) : NULL;
+        if(!art) art = embedded(candidates[i]);
+        if(art) return art;
+    }
+    return NULL;
+}
@@ -2,23 +2,28 @@
 // Build: make
 // Run  : ./ultrafetch
 
+#include "common.h"      // first: carries _GNU_SOURCE
+
 #include <stdio.h>       
 #include <string.h>      
-#include <sys/utsname.h> 
 #include <stdlib.h>
 #include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
 
-#include "common.h"
-#include "os.h"
-#include "cpu.h"              
-#include "gpu.h"
-#include "ram.h"
-#include "memory.h"
-#include "swap.h"
-#include "host.h"
-#include "terminalshell.h"
-#include "terminalfont.h"
-#include "uptime.h"
+#include "pool.h"
+#include "module.h"
+#include "cache.h"
+#include "daemon.h"
+#include "exporter.h"
+#include "record.h"
+#include "factsnap.h"
+#include "bench.h"
+#include "trace.h"
+#include "logo.h"
+#include "frame.h"
+#include "template.h"
 
 #define UF_VERSION "2.1.0"
 #define LABEL_WIDTH 16
@@ -30,105 +35,153 @@ typedef struct {
     int show_icons;
     int color_mode;
     int minimal;
+    int jobs;
+    int no_cache;
+    int allow_spawn;
+    int timeout_ms;
+    int watch_ms;
+    int bench;
+    int daemon;
+    int client;
+    int interval_ms;
+    char socket_path[108];
+    int exporter;
+    const char* listen;
+    const char* textfile;
+    const char* sysroot;
+    const char* record;
+    const char* replay;
+    const char* save_snapshot;
+    const char* diff_snapshot[2];
+    int diff_count;
+    const char* trace;
+    const char* logo_dir;
+    int side_by_side;
+    int format;
+    const char* template_src;
+    int fields[UF_MOD_COUNT];   // explicit --fields selection, in output order
+    int field_count;
 } uf_options_t;
 
-// declare dummy global opts here
-uf_options_t opts;
-// forward declaration
-// forward declare
-static void kv(const char* label, const char* value, uf_options_t* opts, const char* icon_type);
+enum { UF_COLOR_LABEL, UF_COLOR_VALUE, UF_COLOR_RESET };
+enum { UF_FORMAT_TEXT, UF_FORMAT_JSON, UF_FORMAT_TEMPLATE };
+
+static const char* const color_table[4][3] = {
+    [0] = { "",           "",           ""        },
+    [1] = { "\033[1;36m", "\033[0;37m", "\033[0m" },
+    [2] = { "\033[1;32m", "\033[1;33m", "\033[0m" },
+    [3] = { "\033[1;35m", "\033[1;31m", "\033[0m" },
+};
 
-static void kv_silent(const char* label, char* out, uf_options_t* opts, const char* icon_type){
-    if(!out) return;
-    // manggil kv asli tapi buang outputnya
-    fflush(stdout);
-    int fd = dup(fileno(stdout));
-    freopen("/dev/null", "w", stdout);     // redirect stdout sementara
-    kv(label, out, opts, icon_type);       // ini akan ngisi buffer + print (tapi ke /dev/null)
-    fflush(stdout);
-    dup2(fd, fileno(stdout));              // restore stdout
-    close(fd);
+static const char* get_color(int color_mode, int slot) {
+    if (color_mode < 0 || color_mode > 3) return "";
+    return color_table[color_mode][slot];
 }
 
-static void print_logo(void){
-    char s_os[128] = {0};
-    os_string(s_os, sizeof(s_os));   // ambil OS string asli, bukan kv()
+// Icons carry their own trailing spaces for terminals that draw them one
+// column wide; measure the glyph instead and pad to a fixed column.
+#define ICON_WIDTH 3
 
-    char name[64] = {0};
-    int j = 0;
-    for(char *p = s_os; *p && j < (int)sizeof(name) - 1; p++){
-        if(*p==' '||*p=='\t') break;
-        char c=*p;
-        if(c>='A'&&c<='Z') c=(char)(c-'A'+'a');
-        name[j++]=c;
+static void kv(uf_frame_t* f, const char* label, const char* value, const uf_options_t* opts, const char* icon){
+    if (!label || !value) return;
+    
+    const char* label_color = get_color(opts->color_mode, UF_COLOR_LABEL);
+    const char* value_color = get_color(opts->color_mode, UF_COLOR_VALUE);
+    const char* reset_color = get_color(opts->color_mode, UF_COLOR_RESET);
+    
+    if (opts->show_icons && icon) {
+        size_t len = strlen(icon);
+        while (len > 0 && icon[len - 1] == ' ') len--;
+        uf_frame_put(f, icon, len);
+        uf_frame_pad(f, ICON_WIDTH - uf_text_width(icon, len));
     }
-    name[j]=0;
-
-    char path[256];
-    snprintf(path,sizeof(path),"logos/%s.txt",*name?name:"xFetch");
-
-    FILE*f=fopen(path,"r");
-    if(!f) f=fopen("logos/xFetch.txt","r");
-    if(!f) return;
+    uf_frame_puts(f, label_color);
+    uf_frame_puts(f, label);
+    uf_frame_pad(f, LABEL_WIDTH - uf_text_width(label, strlen(label)));
+    uf_frame_printf(f, "%s%s: %s%s%s\n", reset_color,
+                    value_color, value[0] ? value : "N/A", reset_color, "");
+}
 
-    int rainbow[]={196,202,208,214,220,226,190,82,46,49,51,39,33,27,93,129,201,198};
-    int rlen=sizeof(rainbow)/sizeof(rainbow[0]);
-    char line[512];int i=0;
-    while(fgets(line,sizeof(line),f)){
-        printf("\033[38;5;%dm%s\033[0m",rainbow[i%rlen],line);
-        i++;
+// The fields of a fact with their JSON types; NONE becomes null.
+static void json_fact(uf_json_t* j, const uf_fact_t* fact){
+    for (int i = 0; i < fact->count; i++) {
+        const uf_field_t* fld = &fact->field[i];
+        if (strcmp(fld->key, "value") == 0) continue;   // already written
+        switch (fld->type) {
+        case UF_FACT_STR:
+            uf_json_str(j, fld->key, uf_fact_field_str(fact, fld));
+            break;
+        case UF_FACT_INT: case UF_FACT_BYTES: case UF_FACT_SECONDS:
+            uf_json_int(j, fld->key, fld->v.i);
+            break;
+        case UF_FACT_MHZ: case UF_FACT_CELSIUS: case UF_FACT_PERCENT:
+            uf_json_num(j, fld->key, fld->v.d);
+            break;
+        default:
+            uf_json_null(j, fld->key);
+        }
     }
-    fclose(f);
 }
 
-
-static const char* get_icon(const char* type) {
-    if (strcmp(type, "os") == 0) return "🖥️  ";
-    if (strcmp(type, "host") == 0) return "💻 ";
-    if (strcmp(type, "kernel") == 0) return "⚙️  ";
-    if (strcmp(type, "arch") == 0) return "🏗️  ";
-    if (strcmp(type, "shell") == 0) return "🐚 ";
-    if (strcmp(type, "terminal") == 0) return "📟 ";
-    if (strcmp(type, "font") == 0) return "🔤 ";
-    if (strcmp(type, "uptime") == 0) return "⏰ ";
-    if (strcmp(type, "cpu") == 0) return "🔥 ";
-    if (strcmp(type, "gpu") == 0) return "🎮 ";
-    if (strcmp(type, "ram") == 0) return "💾 ";
-    if (strcmp(type, "memory") == 0) return "🗂️  ";
-    if (strcmp(type, "swap") == 0) return "💿 ";
-    return "";
+// One JSON object per module, keyed like --fields: the display value plus
+// the module's typed fields. Always a single line, so watch mode streams
+// NDJSON.
+static int render_json(uf_frame_t* f, uf_registry_t* reg, const int* ids, size_t count){
+    uf_json_t j;
+    uf_json_init(&j, f->buf + f->len, sizeof(f->buf) - f->len);
+    uf_json_object(&j, NULL);
+    for (size_t i = 0; i < count; i++) {
+        uf_json_object(&j, uf_modules[ids[i]].key);
+        uf_json_str(&j, "value", uf_registry_value(reg, ids[i]));
+        json_fact(&j, uf_registry_fact(reg, ids[i]));
+        uf_json_end(&j);
+    }
+    uf_json_end(&j);
+    if (j.overflow) {
+        fprintf(stderr, "ultrafetch: JSON output exceeds %d bytes\n", UF_FRAME_MAX);
+        return -1;
+    }
+    f->len += j.len;
+    uf_frame_put(f, "\n", 1);
+    return 0;
 }
 
-static const char* get_color(int color_mode, const char* type) {
-    if (color_mode == 0) return "";
-    
-    if (color_mode == 1) {
-        if (strcmp(type, "label") == 0) return "\033[1;36m";
-        if (strcmp(type, "value") == 0) return "\033[0;37m";
-        if (strcmp(type, "reset") == 0) return "\033[0m";
-    } else if (color_mode == 2) {
-        if (strcmp(type, "label") == 0) return "\033[1;32m";
-        if (strcmp(type, "value") == 0) return "\033[1;33m";
-        if (strcmp(type, "reset") == 0) return "\033[0m";
-    } else if (color_mode == 3) {
-        if (strcmp(type, "label") == 0) return "\033[1;35m";
-        if (strcmp(type, "value") == 0) return "\033[1;31m";
-        if (strcmp(type, "reset") == 0) return "\033[0m";
+// Comma separated module keys -> registry ids, in the given order.
+static int parse_fields(const char* list, uf_options_t* opts) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", list);
+    opts->field_count = 0;
+    
+    char* save = NULL;
+    for (char* tok = strtok_r(buf, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+        uf_trim(tok);
+        int id = uf_module_find(tok);
+        if (id < 0) {
+            fprintf(stderr, "ultrafetch: unknown field '%s'\n", tok);
+            return -1;
+        }
+        if (opts->field_count < UF_MOD_COUNT) opts->fields[opts->field_count++] = id;
     }
-    return "";
+    return 0;
 }
 
-static void kv(const char* label, const char* value, uf_options_t* opts, const char* icon_type){
-    if (!label || !value) return;
-    
-    const char* icon = opts->show_icons ? get_icon(icon_type) : "";
-    const char* label_color = get_color(opts->color_mode, "label");
-    const char* value_color = get_color(opts->color_mode, "value");
-    const char* reset_color = get_color(opts->color_mode, "reset");
+// Lines that will actually be printed; only these modules get collected.
+static size_t select_fields(const uf_options_t* opts, int* ids) {
+    if (opts->field_count > 0) {
+        memcpy(ids, opts->fields, sizeof(int) * (size_t)opts->field_count);
+        return (size_t)opts->field_count;
+    }
     
-    printf("%s%s%-*s%s%s: %s%s%s\n", 
-           icon, label_color, LABEL_WIDTH, label, reset_color,
-           value_color, (value && value[0]) ? value : "N/A", reset_color, "");
+    size_t count = 0;
+    for (int i = 0; i < UF_MOD_COUNT; i++) {
+        const uf_module_t* m = &uf_modules[i];
+        if (opts->show_less && (m->flags & UF_MOD_DETAIL)) continue;
+        if (opts->minimal && m->cost >= UF_COST_SPAWN) continue;
+        // the live CPU fields are part of the record, not extra screen lines
+        if (!opts->watch_ms && opts->format != UF_FORMAT_JSON && (m->flags & UF_MOD_WATCH)) continue;
+        ids[count++] = i;
+    }
+    return count;
 }
 
 static int parse_args(int argc, char** argv, uf_options_t* opts) {
@@ -160,6 +213,105 @@ static int parse_args(int argc, char** argv, uf_options_t* opts) {
             opts->minimal = 1;
             opts->show_less = 1;
         }
+        else if(strcmp(argv[i], "--parallel") == 0){
+            if(opts->jobs <= 1) opts->jobs = 4;
+        }
+        else if(strcmp(argv[i], "--fields") == 0){
+            if(i + 1 >= argc || parse_fields(argv[++i], opts) != 0) return -1;
+        }
+        else if(strcmp(argv[i], "--timeout-ms") == 0){
+            if(i + 1 < argc) {
+                int ms = atoi(argv[++i]);
+                if(ms >= 0) opts->timeout_ms = ms;
+            }
+        }
+        else if(strcmp(argv[i], "--bench") == 0){
+            opts->bench = 10;
+            if(i + 1 < argc && atoi(argv[i + 1]) > 0) opts->bench = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--watch") == 0){
+            if(i + 1 < argc) {
+                int ms = atoi(argv[++i]);
+                if(ms > 0) opts->watch_ms = ms;
+            }
+        }
+        else if(strcmp(argv[i], "--daemon") == 0){
+            opts->daemon = 1;
+        }
+        else if(strcmp(argv[i], "--client") == 0){
+            opts->client = 1;
+        }
+        else if(strcmp(argv[i], "--socket") == 0){
+            if(i + 1 < argc) snprintf(opts->socket_path, sizeof(opts->socket_path), "%s", argv[++i]);
+        }
+        else if(strcmp(argv[i], "--exporter") == 0){
+            opts->exporter = 1;
+        }
+        else if(strcmp(argv[i], "--listen") == 0){
+            if(i + 1 < argc) opts->listen = argv[++i];
+        }
+        else if(strcmp(argv[i], "--textfile") == 0){
+            if(i + 1 < argc) opts->textfile = argv[++i];
+        }
+        else if(strcmp(argv[i], "--interval-ms") == 0){
+            if(i + 1 < argc) {
+                int ms = atoi(argv[++i]);
+                if(ms > 0) opts->interval_ms = ms;
+            }
+        }
+        else if(strcmp(argv[i], "--sysroot") == 0){
+            if(i + 1 < argc) opts->sysroot = argv[++i];
+        }
+        else if(strcmp(argv[i], "--format") == 0){
+            if(i + 1 >= argc) return -1;
+            const char* fmt = argv[++i];
+            if(strcmp(fmt, "text") == 0) opts->format = UF_FORMAT_TEXT;
+            else if(strcmp(fmt, "json") == 0) opts->format = UF_FORMAT_JSON;
+            else if(strchr(fmt, '{')) {
+                opts->format = UF_FORMAT_TEMPLATE;
+                opts->template_src = fmt;
+            }
+            else {
+                fprintf(stderr, "ultrafetch: unknown format '%s'\n", fmt);
+                return -1;
+            }
+        }
+        else if(strcmp(argv[i], "--side-by-side") == 0){
+            opts->side_by_side = 1;
+        }
+        else if(strcmp(argv[i], "--logo-dir") == 0){
+            if(i + 1 < argc) opts->logo_dir = argv[++i];
+        }
+        else if(strcmp(argv[i], "--record") == 0){
+            if(i + 1 < argc) opts->record = argv[++i];
+        }
+        else if(strcmp(argv[i], "--replay") == 0){
+            if(i + 1 < argc) opts->replay = argv[++i];
+        }
+        else if(strcmp(argv[i], "--save-snapshot") == 0){
+            if(i + 1 < argc) opts->save_snapshot = argv[++i];
+        }
+        else if(strcmp(argv[i], "--diff-snapshot") == 0){
+            if(i + 1 < argc){
+                i++;
+                if(opts->diff_count < 2) opts->diff_snapshot[opts->diff_count++] = argv[i];
+            }
+        }
+        else if(strcmp(argv[i], "--trace") == 0){
+            if(i + 1 < argc) opts->trace = argv[++i];
+        }
+        else if(strcmp(argv[i], "--allow-spawn") == 0){
+            opts->allow_spawn = 1;
+        }
+        else if(strcmp(argv[i], "--no-cache") == 0){
+            opts->no_cache = 1;
+        }
+        else if(strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--jobs") == 0){
+            if(i + 1 < argc) {
+                int jobs = atoi(argv[++i]);
+                if(jobs >= 1 && jobs <= UF_POOL_MAX_WORKERS) opts->jobs = jobs;
+            }
+        }
         else {
             fprintf(stderr, "ultrafetch: unknown option '%s'\n", argv[i]);
             return -1;
@@ -179,17 +331,266 @@ static void print_usage(const char* argv0){
     printf("    --show-less      Reduce output details\n");
     printf("    --icon           Show icons\n");
     printf("    --color <0-3>    Color scheme (0=off, 1=cyan, 2=green, 3=magenta)\n");
+    printf("    --parallel       Collect modules concurrently (4 workers)\n");
+    printf("    -j, --jobs <n>   Number of collector threads (1-%d)\n", UF_POOL_MAX_WORKERS);
+    printf("    --no-cache       Ignore and do not update the fact cache\n");
+    printf("    --allow-spawn    Let probes run external tools (nvidia-smi, --version, ...)\n");
+    printf("    --timeout-ms <n> Total time budget; slow probes report N/A (timeout)\n");
+    printf("    --bench [n]      Time each module n times (default 10) and report I/O\n");
+    printf("    --watch <ms>     Stay open and redraw volatile fields every <ms>\n");
+    printf("    --daemon         Keep collecting in the background and serve clients\n");
+    printf("    --client         Print the daemon's snapshot (collects locally if none)\n");
+    printf("    --socket <path>  Daemon socket (default $XDG_RUNTIME_DIR/xfetch.sock)\n");
+    printf("    --exporter       Serve Prometheus metrics (needs --listen or --textfile)\n");
+    printf("    --listen <addr>  Exporter address, e.g. 127.0.0.1:9101 or [::1]:9101\n");
+    printf("    --textfile <path> Write the metrics for node_exporter's textfile collector\n");
+    printf("                     (once, or every --interval-ms)\n");
+    printf("    --interval-ms <n> Daemon re-sample interval for volatile modules; for\n");
+    printf("                     --listen, the minimum time between two samples\n");
+    printf("    --format <fmt>   text (default), json, or a template such as\n");
+    printf("                     \"{cpu.name} {ram.used}/{ram.total}\"; with --watch,\n");
+    printf("                     json and templates print one line per tick\n");
+    printf("    --side-by-side   Print the information next to the logo\n");
+    printf("    --logo-dir <dir> Look for <os-release ID>.txt here before the built-in logos\n");
+    printf("    --sysroot <dir>  Read /proc, /sys and /etc from a captured tree\n");
+    printf("                     (also XFETCH_SYSROOT; implies --no-cache)\n");
+    printf("    --record <file>  Save every file, listing and command seen to an archive\n");
+    printf("    --replay <file>  Run the collectors from a recorded archive only\n");
+    printf("    --save-snapshot <file> Save every collected fact to a binary snapshot\n");
+    printf("    --diff-snapshot <file> Print the facts that differ from a snapshot (given\n");
+    printf("                     twice: between two snapshots); exit 0 if none, 1 if\n");
+    printf("                     some, 2 on error. Compares --fields, or all modules\n");
+    printf("                     that do not change while running\n");
+    printf("    --trace <file>   Write a Chrome/Perfetto trace of the collectors\n");
+    printf("    --fields <list>  Comma separated modules to show, in order\n");
+    printf("                     (os,host,kernel,arch,shell,terminal,font,uptime,\n");
+    printf("                      cpu,perf,gpu,ram,memory,swap)\n");
     printf("\nEXAMPLES:\n");
     printf("    %s              # Standard output\n", argv0);
     printf("    %s --icon       # With icons\n", argv0);
     printf("    %s --color 2    # Green color scheme\n", argv0);
     printf("    %s -m           # Minimal mode\n", argv0);
+    printf("    %s --parallel   # Run slow probes side by side\n", argv0);
+    printf("    %s --fields os,cpu,ram\n", argv0);
+    printf("    %s --watch 1000 # Live uptime, memory and CPU frequency\n", argv0);
+    printf("    %s --format json --fields cpu,ram\n", argv0);
+    printf("    %s --format \"{#cyan}{cpu.name:.20}{#reset} {perf.temperature}\"\n", argv0);
+}
+
+static volatile sig_atomic_t watch_stop;
+
+static void watch_signal(int sig){
+    (void)sig;
+    watch_stop = 1;
+}
+
+static uf_frame_t out_frame;
+static uf_frame_t info_frame;
+static uf_template_t out_template;
+
+// --diff-snapshot against the live registry, or (given twice, reg NULL)
+// between two files. Volatile readings would differ on every run, so
+// without --fields only the modules that hold still are compared.
+static int diff_snapshots(const uf_options_t* opts, uf_registry_t* reg) {
+    unsigned char select[UF_MOD_COUNT];
+    for (int i = 0; i < UF_MOD_COUNT; i++)
+        select[i] = opts->field_count == 0 && !(uf_modules[i].flags & UF_MOD_VOLATILE);
+    for (int i = 0; i < opts->field_count; i++) select[opts->fields[i]] = 1;
+    
+    uf_factsnap_t old, cur;
+    const char* path = reg ? NULL : opts->diff_snapshot[1];
+    if (uf_factsnap_open(&old, opts->diff_snapshot[0]) != 0) {
+        fprintf(stderr, "ultrafetch: cannot read snapshot %s: %s\n", opts->diff_snapshot[0], strerror(errno));
+        return 2;
+    }
+    if (path ? uf_factsnap_open(&cur, path) != 0 : uf_factsnap_build(&cur, reg) != 0) {
+        fprintf(stderr, "ultrafetch: cannot read snapshot %s: %s\n", path ? path : "of this system", strerror(errno));
+        uf_factsnap_close(&old);
+        return 2;
+    }
+    uf_frame_init(&out_frame, STDOUT_FILENO);
+    int changes = uf_factsnap_diff(&old, &cur, select, &out_frame);
+    uf_factsnap_close(&old);
+    uf_factsnap_close(&cur);
+    if (uf_frame_flush(&out_frame) != 0) return 2;
+    return changes ? 1 : 0;
+}
+
+// Re-sample the volatile modules every tick and rewrite only the lines whose
+// value changed, all of them in one write. Between ticks the cursor parks on
+// the line below the footer, two rows under the bottom of the frame.
+static void watch_loop(uf_registry_t* reg, const int* ids, size_t count, uf_options_t* opts,
+                       int from_daemon, const uf_layout_t* layout){
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = watch_signal;   // no SA_RESTART: the sleep has to wake up
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    
+    static char prev[UF_MOD_COUNT][UF_VALUE_MAX];
+    uf_frame_t* f = &out_frame;
+    int json = opts->format == UF_FORMAT_JSON;
+    int redraw = opts->format == UF_FORMAT_TEXT;
+    
+    if (redraw) {
+        uf_frame_puts(f, "\033[?25l");
+        uf_frame_flush(f);
+    }
+    
+    while (!watch_stop) {
+        struct timespec ts = { opts->watch_ms / 1000, (long)(opts->watch_ms % 1000) * 1000000L };
+        nanosleep(&ts, NULL);
+        if (watch_stop) break;
+        
+        for (size_t i = 0; i < count; i++)
+            snprintf(prev[i], sizeof(prev[i]), "%s", uf_registry_value(reg, ids[i]));
+        
+        if (!(from_daemon && uf_client_fetch(opts->socket_path, reg))) {
+            if (opts->timeout_ms > 0) UF_DEADLINE_MS = uf_now_ms() + opts->timeout_ms;
+            uf_registry_invalidate_volatile(reg);
+            uf_registry_collect(reg, ids, count, opts->jobs);
+        }
+        
+        if (opts->format == UF_FORMAT_TEMPLATE) {
+            uf_template_render(&out_template, reg, opts->color_mode != 0, f);
+            uf_frame_flush(f);
+            continue;
+        }
+        if (json) {
+            // a complete object every tick, changed or not
+            if (render_json(f, reg, ids, count) == 0) uf_frame_flush(f);
+            continue;
+        }
+        
+        for (size_t i = 0; i < count; i++) {
+            const char* cur = uf_registry_value(reg, ids[i]);
+            if (strcmp(prev[i], cur) == 0) continue;
+            
+            const uf_module_t* m = &uf_modules[ids[i]];
+            int up = layout->rows + 2 - (layout->info_top + (int)i);
+            // erase from the info column on, so a logo beside it survives
+            uf_frame_printf(f, "\033[%dA\033[%dG\033[K", up, layout->info_col);
+            kv(f, m->label, cur, opts, m->icon);
+            uf_frame_printf(f, "\033[%dB", up - 1);
+        }
+        uf_frame_flush(f);
+    }
+    
+    if (redraw) {
+        uf_frame_puts(f, "\033[?25h");
+        uf_frame_flush(f);
+    }
 }
 
 static void print_version(void){
     printf("ultrafetch %s\n", UF_VERSION);
 }
 
+// Everything after option handling; main finishes the trace whichever way
+// this returns.
+static int run(uf_options_t* opts){
+    // two snapshot files: nothing to collect
+    if (opts->diff_count > 1) return diff_snapshots(opts, NULL);
+    
+    int ids[UF_MOD_COUNT];
+    size_t count = select_fields(opts, ids);
+    
+    if (opts->format == UF_FORMAT_TEMPLATE) {
+        char err[128];
+        if (uf_template_compile(&out_template, opts->template_src, err, sizeof(err)) != 0) {
+            fprintf(stderr, "ultrafetch: bad template: %s\n", err);
+            return 1;
+        }
+        // only what the template mentions gets collected
+        memcpy(ids, out_template.ids, sizeof(int) * out_template.id_count);
+        count = out_template.id_count;
+    }
+    
+    if (opts->bench) {
+        // every collector unless --fields narrowed it down
+        if (opts->field_count == 0)
+            for (count = 0; count < UF_MOD_COUNT; count++) ids[count] = (int)count;
+        uf_detect_android();
+        unsigned long long spawns = uf_bench_run(ids, count, opts->bench);
+        // the default path must never fork; a regression shows up here
+        if (spawns && !opts->allow_spawn) {
+            fprintf(stderr, "ultrafetch: %llu child processes without --allow-spawn\n", spawns);
+            return 1;
+        }
+        return 0;
+    }
+    
+    uf_registry_t reg;
+    int from_daemon = 0;
+    if (opts->client) {
+        uf_registry_init(&reg, !opts->no_cache);
+        from_daemon = uf_client_fetch(opts->socket_path, &reg);
+        if (from_daemon) {
+            // the daemon leaves out what depends on our own environment
+            uf_registry_collect(&reg, ids, count, opts->jobs);
+            uf_registry_finish(&reg);
+        }
+    }
+    
+    if (!from_daemon) {
+        UF_TRACE_BEGIN("collect");
+        uf_detect_android();
+        uf_registry_init(&reg, !opts->no_cache);
+        // join point: rendering starts only after every selected collector returned
+        uf_registry_collect(&reg, ids, count, opts->jobs);
+        if (opts->record || opts->save_snapshot || opts->diff_count) {
+            // capture every module so the archive replays any --fields choice
+            // and a snapshot holds the whole machine
+            int all[UF_MOD_COUNT];
+            for (int i = 0; i < UF_MOD_COUNT; i++) all[i] = i;
+            uf_registry_collect(&reg, all, UF_MOD_COUNT, opts->jobs);
+        }
+        uf_registry_finish(&reg);
+        UF_TRACE_END();
+    }
+    if (opts->record && uf_snap_finish() != 0) return 1;
+    
+    if (opts->save_snapshot) {
+        uf_factsnap_t snap;
+        int ok = uf_factsnap_build(&snap, &reg) == 0 && uf_factsnap_save(&snap, opts->save_snapshot) == 0;
+        uf_factsnap_close(&snap);
+        if (!ok) return 1;
+    }
+    if (opts->diff_count) return diff_snapshots(opts, &reg);
+    
+    uf_layout_t layout = {0};
+    uf_frame_init(&out_frame, STDOUT_FILENO);
+    if (opts->format == UF_FORMAT_JSON) {
+        if (render_json(&out_frame, &reg, ids, count) != 0) return 1;
+    } else if (opts->format == UF_FORMAT_TEMPLATE) {
+        uf_template_render(&out_template, &reg, opts->color_mode != 0, &out_frame);
+    } else {
+        uf_frame_init(&info_frame, -1);
+        for (size_t i = 0; i < count; i++) {
+            const uf_module_t* m = &uf_modules[ids[i]];
+            kv(&info_frame, m->label, uf_registry_value(&reg, ids[i]), opts, m->icon);
+        }
+        
+        uf_frame_compose(&out_frame, opts->minimal ? NULL : uf_logo_resolve(opts->logo_dir),
+                         info_frame.buf, info_frame.len, opts->side_by_side, &layout);
+        
+        const char* footer_color = get_color(opts->color_mode, UF_COLOR_LABEL);
+        const char* reset_color = get_color(opts->color_mode, UF_COLOR_RESET);
+        uf_frame_printf(&out_frame, "\n%sultrafetch (C modular)%s\n", footer_color, reset_color);
+    }
+    fflush(stdout);   // anything stdio still holds has to land before the frame
+    if (uf_frame_flush(&out_frame) != 0) return 1;
+    
+#ifdef UF_TRACE
+    // written now: --watch only ends on a signal
+    if (uf_trace_finish() != 0) return 1;
+#endif
+    
+    if (opts->watch_ms > 0) watch_loop(&reg, ids, count, opts, from_daemon, &layout);
+    
+    return 0;
+}
+
 int main(int argc, char** argv){
     uf_options_t opts;
     
@@ -207,73 +608,64 @@ int main(int argc, char** argv){
         return 0;
     }
     
-    uf_detect_android();
-    
-    char s_os[256] = {0};
-    char s_host[256] = {0};
-    char s_kernel[128] = {0};
-    char s_arch[64] = {0};
-    char s_shell[256] = {0};
-    char s_term[128] = {0};
-    char s_font[128] = {0};
-    char s_uptime[64] = {0};
-    char s_cpu[256] = {0};
-    char s_gpu[256] = {0};
-    char s_ram[64] = {0};
-    char s_memory[128] = {0};
-    char s_swap[64] = {0};
-    
-    os_string(s_os, sizeof(s_os));
-    host_string(s_host, sizeof(s_host));
-    shell_string(s_shell, sizeof(s_shell));
-    terminal_string(s_term, sizeof(s_term));
-    uptime_string(s_uptime, sizeof(s_uptime));
-    
-    cpu_string(s_cpu, sizeof(s_cpu));
-    gpu_string(s_gpu, sizeof(s_gpu));
-    ram_string(s_ram, sizeof(s_ram));
-    swap_string(s_swap, sizeof(s_swap));
-    
-    if (!opts.show_less) {
-        terminal_font_string(s_font, sizeof(s_font));
-        memory_summary(s_memory, sizeof(s_memory));
-    }
+    if (!opts.sysroot) opts.sysroot = getenv("XFETCH_SYSROOT");
+    if (!opts.logo_dir) opts.logo_dir = getenv("XFETCH_LOGO_DIR");
+    uf_sysroot_set(opts.sysroot);
+    // cached facts belong to the running system, not to the tree
+    if (uf_sysroot()[0]) opts.no_cache = 1;
+    UF_ALLOW_SPAWN = opts.allow_spawn;
     
-    struct utsname u;
-    if(uname(&u) == 0){
-        snprintf(s_kernel, sizeof(s_kernel), "%s", u.release);
-        snprintf(s_arch, sizeof(s_arch), "%s", u.machine);
+    if (opts.replay) {
+        if (uf_snap_replay(opts.replay) != 0) {
+            fprintf(stderr, "ultrafetch: cannot replay %s: %s\n", opts.replay, strerror(errno));
+            return 1;
+        }
+        opts.no_cache = 1;
+    } else if (opts.record) {
+        uf_snap_record(opts.record);
+        opts.no_cache = 1;
     }
+    if (opts.no_cache) uf_cache_disable();
     
-    if (!opts.minimal) print_logo();
+    if (!opts.socket_path[0]) uf_daemon_socket_path(opts.socket_path, sizeof(opts.socket_path));
     
-    kv("OS", s_os, &opts, "os");
-    kv("Host", s_host, &opts, "host");
-    kv("Kernel", s_kernel, &opts, "kernel");
-    kv("Arch", s_arch, &opts, "arch");
-    kv("Shell", s_shell, &opts, "shell");
-    kv("Terminal", s_term, &opts, "terminal");
-    
-    if (!opts.show_less) {
-        kv("Font", s_font, &opts, "font");
+    // these run until signalled; a trace would only grow
+    if (opts.trace && (opts.daemon || opts.exporter || opts.textfile)) {
+        fprintf(stderr, "ultrafetch: --trace cannot be combined with --daemon, --exporter or --textfile\n");
+        return 1;
     }
     
-    kv("Uptime", s_uptime, &opts, "uptime");
-    kv("CPU", s_cpu, &opts, "cpu");
-    kv("GPU", s_gpu, &opts, "gpu");
-    kv("RAM", s_ram, &opts, "ram");
+    if (opts.daemon) {
+        uf_detect_android();
+        return uf_daemon_run(opts.socket_path, opts.interval_ms, opts.jobs, !opts.no_cache) == 0 ? 0 : 1;
+    }
     
-    if (!opts.show_less) {
-        kv("Memory", s_memory, &opts, "memory");
+    if (opts.exporter || opts.textfile) {
+        uf_detect_android();
+        if (opts.textfile)
+            return uf_exporter_textfile(opts.textfile, opts.interval_ms, opts.jobs, !opts.no_cache) == 0 ? 0 : 1;
+        if (!opts.listen) {
+            fprintf(stderr, "ultrafetch: --exporter needs --listen <addr:port> or --textfile <path>\n");
+            return 1;
+        }
+        return uf_exporter_serve(opts.listen, opts.interval_ms, opts.jobs, !opts.no_cache) == 0 ? 0 : 1;
     }
     
-    kv("Swap", s_swap, &opts, "swap");
+    if (opts.timeout_ms > 0) UF_DEADLINE_MS = uf_now_ms() + opts.timeout_ms;
     
-    const char* footer_color = get_color(opts.color_mode, "label");
-    const char* reset_color = get_color(opts.color_mode, "reset");
-    printf("\n%sultrafetch (C modular)%s\n", footer_color, reset_color);
+    if (opts.trace) {
+#ifdef UF_TRACE
+        uf_trace_open(opts.trace);
+#else
+        fprintf(stderr, "ultrafetch: built without tracing (make TRACE=1), ignoring --trace\n");
+#endif
+    }
     
-    return 0;
+    int rc = run(&opts);
+#ifdef UF_TRACE
+    if (uf_trace_finish() != 0 && rc == 0) rc = 1;
+#endif
+    return rc;
 }
 
 /*
@@ -0,0 +1,47 @@
+// src/mapping.c — lookups over the tables generated from mapping/*.txt
+#include "common.h"
+#include "mapping.h"
+#include <string.h>
+#include <ctype.h>
+
+const char* uf_map_find_str(const uf_map_str_t* map, size_t count, const char* key){
+    size_t lo = 0, hi = count;
+    while(lo < hi){
+        size_t mid = lo + (hi - lo) / 2;
+        int c = strcmp(map[mid].key, key);
+        if(c == 0) return map[mid].value;
+        if(c < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return NULL;
+}
+
+const char* uf_map_find_num(const uf_map_num_t* map, size_t count, uint32_t key){
+    size_t lo = 0, hi = count;
+    while(lo < hi){
+        size_t mid = lo + (hi - lo) / 2;
+        if(map[mid].key == key) return map[mid].value;
+        if(map[mid].key < key) lo = mid + 1;
+        else hi = mid;
+    }
+    return NULL;
+}
+
+const char* uf_map_soc_name(const char* hardware_id){
+    if(!hardware_id) return NULL;
+    // leading letters, upper-cased, then the first run of digits
+    char key[32];
+    size_t n = 0;
+    const char* p = hardware_id;
+    while(isalpha((unsigned char)*p) && n < sizeof(key) - 1) key[n++] = (char)toupper((unsigned char)*p++);
+    if(n == 0) return NULL;
+    while(*p && !isdigit((unsigned char)*p)) p++;
+    while(isdigit((unsigned char)*p) && n < sizeof(key) - 1) key[n++] = *p++;
+    key[n] = 0;
+    return uf_map_find_str(uf_map_soc, uf_map_soc_count, key);
+}
+
+const char* uf_map_arm_part(unsigned implementer, unsigned part){
+    if(implementer > 0xff || part > 0xfff) return NULL;
+    return uf_map_find_num(uf_map_arm_parts, uf_map_arm_parts_count, implementer << 12 | part);
+}
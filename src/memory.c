@@ -4,20 +4,23 @@
 #include <sys/sysinfo.h>
 #include <stdio.h>
 
-void memory_summary(char* out, size_t n){
+void memory_fact(uf_fact_t* f){
     struct sysinfo si;
-    if(sysinfo(&si)==0){
-        unsigned long long total = (unsigned long long)si.totalram * si.mem_unit;
-        unsigned long long freeb = (unsigned long long)si.freeram * si.mem_unit;
-        unsigned long long buff = (unsigned long long)si.bufferram * si.mem_unit;
-        unsigned long long avail = freeb + buff;
-        unsigned long long used = total - avail;
-        int pct = total ? (int)((used*100)/total) : 0;
-        char t[32], a[32];
-        uf_human_bytes(total, t);
-        uf_human_bytes(avail, a);
-        snprintf(out,n,"Total %s, Avail %s (%d%% used)", t, a, pct);
-    }else{
-        snprintf(out,n,"N/A");
-    }
+    if(uf_sysinfo(&si)!=0) return;
+    unsigned long long total = (unsigned long long)si.totalram * si.mem_unit;
+    unsigned long long freeb = (unsigned long long)si.freeram * si.mem_unit;
+    unsigned long long buff = (unsigned long long)si.bufferram * si.mem_unit;
+    unsigned long long avail = freeb + buff;
+    uf_fact_int(f, "total", UF_FACT_BYTES, (long long)total);
+    uf_fact_int(f, "available", UF_FACT_BYTES, (long long)avail);
+    uf_fact_num(f, "used_percent", UF_FACT_PERCENT, total ? (double)(total - avail) * 100.0 / (double)total : 0.0);
+}
+
+void memory_text(const uf_fact_t* f, char* out, size_t n){
+    long long total = uf_fact_get_int(f, "total", -1);
+    if(total < 0){ snprintf(out,n,"N/A"); return; }
+    char t[32], a[32];
+    uf_human_bytes((unsigned long long)total, t);
+    uf_human_bytes((unsigned long long)uf_fact_get_int(f, "available", 0), a);
+    snprintf(out,n,"Total %s, Avail %s (%d%% used)", t, a, (int)uf_fact_get_num(f, "used_percent", 0));
 }
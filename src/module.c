@@ -0,0 +1,246 @@
+// src/module.c — module registry: one descriptor per output line
+#include "common.h"
+#include "module.h"
+#include "pool.h"
+#include "cache.h"
+#include "os.h"
+#include "cpu.h"
+#include "gpu.h"
+#include "ram.h"
+#include "memory.h"
+#include "swap.h"
+#include "host.h"
+#include "terminalshell.h"
+#include "terminalfont.h"
+#include "uptime.h"
+#include <stdio.h>
+#include <string.h>
+
+const uf_module_t uf_modules[UF_MOD_COUNT] = {
+    [UF_MOD_OS]       = { "os",       "OS",       "🖥️  ", os_string,            UF_COST_FILE,  0,             NULL,                  500 },
+    [UF_MOD_HOST]     = { "host",     "Host",     "💻 ", NULL,                 UF_COST_FILE,  UF_MOD_CACHED, NULL,                 1000, host_fact,     host_text },
+    [UF_MOD_KERNEL]   = { "kernel",   "Kernel",   "⚙️  ", kernel_string,        UF_COST_CHEAP, 0,             NULL,                    0 },
+    [UF_MOD_ARCH]     = { "arch",     "Arch",     "🏗️  ", arch_string,          UF_COST_CHEAP, 0,             NULL,                    0 },
+    [UF_MOD_SHELL]    = { "shell",    "Shell",    "🐚 ", shell_string,         UF_COST_FILE,  UF_MOD_CACHED | UF_MOD_ENV, shell_cache_stamp,    1000 },
+    [UF_MOD_TERMINAL] = { "terminal", "Terminal", "📟 ", terminal_string,      UF_COST_CHEAP, UF_MOD_CACHED | UF_MOD_ENV, terminal_cache_stamp, 1000 },
+    [UF_MOD_FONT]     = { "font",     "Font",     "🔤 ", terminal_font_string, UF_COST_CHEAP, UF_MOD_DETAIL | UF_MOD_ENV, NULL,                    0 },
+    [UF_MOD_UPTIME]   = { "uptime",   "Uptime",   "⏰ ", NULL,                 UF_COST_CHEAP, UF_MOD_VOLATILE, NULL,                  0, uptime_fact,   uptime_text },
+    [UF_MOD_CPU]      = { "cpu",      "CPU",      "🔥 ", NULL,                 UF_COST_FILE,  UF_MOD_CACHED, NULL,                 1000, cpu_fact,      cpu_text },
+    [UF_MOD_PERF]     = { "perf",     "CPU Perf", "🌡️  ", NULL,                 UF_COST_FILE,  UF_MOD_VOLATILE | UF_MOD_WATCH, NULL,   0, cpu_perf_fact, cpu_perf_text },
+    [UF_MOD_GPU]      = { "gpu",      "GPU",      "🎮 ", NULL,                 UF_COST_SPAWN, UF_MOD_CACHED, gpu_cache_stamp,      2000, gpu_fact,      gpu_text, gpu_refresh },
+    [UF_MOD_RAM]      = { "ram",      "RAM",      "💾 ", NULL,                 UF_COST_FILE,  UF_MOD_VOLATILE, NULL,                  0, ram_fact,      ram_text },
+    [UF_MOD_MEMORY]   = { "memory",   "Memory",   "🗂️  ", NULL,                 UF_COST_CHEAP, UF_MOD_DETAIL | UF_MOD_VOLATILE, NULL,   0, memory_fact,   memory_text },
+    [UF_MOD_SWAP]     = { "swap",     "Swap",     "💿 ", NULL,                 UF_COST_CHEAP, UF_MOD_VOLATILE, NULL,                  0, swap_fact,     swap_text },
+};
+
+// The keys each typed collector always emits, NONE when undetected.
+static const char* const module_fields[UF_MOD_COUNT][10] = {
+    [UF_MOD_HOST]   = { "name", "family", "vendor", "sku" },
+    [UF_MOD_UPTIME] = { "seconds" },
+    [UF_MOD_CPU]    = { "name", "vendor", "cores_physical", "cores_logical", "cores_online",
+                        "frequency_base", "frequency_max" },
+    [UF_MOD_PERF]   = { "frequency_current", "frequency_base", "frequency_max", "temperature", "governor" },
+    [UF_MOD_GPU]    = { "name", "vendor", "driver", "memory", "temperature" },
+    [UF_MOD_RAM]    = { "total", "used", "available", "cached", "buffers" },
+    [UF_MOD_MEMORY] = { "total", "available", "used_percent" },
+    [UF_MOD_SWAP]   = { "total", "used" },
+};
+
+int uf_module_find(const char* key){
+    if(!key) return -1;
+    for(int i=0;i<UF_MOD_COUNT;i++){
+        if(strcmp(uf_modules[i].key, key) == 0) return i;
+    }
+    return -1;
+}
+
+int uf_module_has_field(int id, const char* key){
+    if(id < 0 || id >= UF_MOD_COUNT || !key) return 0;
+    if(strcmp(key, "value") == 0) return 1;
+    for(int i=0;module_fields[id][i];i++){
+        if(strcmp(module_fields[id][i], key) == 0) return 1;
+    }
+    return 0;
+}
+
+void uf_module_collect(int id, uf_fact_t* f){
+    const uf_module_t* m = &uf_modules[id];
+    uf_fact_init(f);
+    if(m->fact){
+        m->fact(f);
+        return;
+    }
+    char value[UF_VALUE_MAX];
+    value[0] = 0;
+    m->collect(value, sizeof(value));
+    uf_fact_str(f, "value", value);
+}
+
+void uf_module_text(int id, const uf_fact_t* f, char* out, size_t n){
+    // a plain string, or whatever stood in for a probe that timed out
+    const char* value = uf_fact_get_str(f, "value");
+    if(value || !uf_modules[id].text) snprintf(out, n, "%s", value ? value : "");
+    else uf_modules[id].text(f, out, n);
+}
+
+static int fact_timed_out(const uf_fact_t* f){
+    const char* value = uf_fact_get_str(f, "value");
+    return value && strcmp(value, UF_TIMEOUT_TEXT) == 0;
+}
+
+// Nothing detected at all: every field is NONE.
+static int fact_empty(const uf_fact_t* f){
+    for(int i=0;i<f->count;i++){
+        if(f->field[i].type != UF_FACT_NONE) return 0;
+    }
+    return 1;
+}
+
+void uf_registry_init(uf_registry_t* reg, int use_cache){
+    memset(reg, 0, sizeof(*reg));
+    reg->use_cache = use_cache;
+    if(use_cache) uf_cache_load();
+}
+
+// Serve a module from the cache; returns 1 on a hit.
+static int registry_try_cache(uf_registry_t* reg, int id){
+    const uf_module_t* m = &uf_modules[id];
+    if(!reg->use_cache || !(m->flags & UF_MOD_CACHED)) return 0;
+    // values probed with --allow-spawn can say more; keep the two apart
+    size_t off = 0;
+    reg->stamp[id][0] = 0;
+    if(UF_ALLOW_SPAWN) off = (size_t)snprintf(reg->stamp[id], sizeof(reg->stamp[id]), "spawn;");
+    if(m->stamp) m->stamp(reg->stamp[id] + off, sizeof(reg->stamp[id]) - off);
+    char encoded[UF_FACT_TEXT_MAX];
+    if(uf_cache_get(m->key, reg->stamp[id], encoded, sizeof(encoded)) &&
+       uf_fact_decode(&reg->fact[id], encoded, strlen(encoded)) > 0){
+        if(m->refresh) m->refresh(&reg->fact[id]);
+        return 1;
+    }
+    reg->missed[id] = 1;
+    return 0;
+}
+
+typedef struct {
+    int id;
+    uf_fact_t* fact;
+} collect_job_t;
+
+static void collect_job(void* arg){
+    collect_job_t* job = arg;
+    uf_module_collect(job->id, job->fact);
+}
+
+void uf_registry_collect(uf_registry_t* reg, const int* ids, size_t count, int jobs){
+    uf_task_t pending[UF_MOD_COUNT];
+    collect_job_t work[UF_MOD_COUNT];
+    size_t pending_count = 0;
+
+    for(size_t i=0;i<count;i++){
+        int id = ids[i];
+        if(id < 0 || id >= UF_MOD_COUNT || reg->ready[id]) continue;
+        reg->ready[id] = 1;
+        reg->shown[id] = 0;
+        if(registry_try_cache(reg, id)) continue;
+        work[pending_count].id = id;
+        work[pending_count].fact = &reg->fact[id];
+        pending[pending_count].name = uf_modules[id].key;
+        pending[pending_count].fn = collect_job;
+        pending[pending_count].arg = &work[pending_count];
+        pending[pending_count].deadline_ms = uf_modules[id].deadline_ms;
+        pending[pending_count].timed_out = 0;
+        pending_count++;
+    }
+
+    // every module writes only into its own slot, so they can run side by side;
+    // this returns only after all of them finished
+    uf_pool_run(pending, pending_count, jobs);
+
+    for(size_t i=0;i<pending_count;i++){
+        if(!pending[i].timed_out) continue;
+        // whatever a timed-out run found is not what the next one would find
+        reg->missed[work[i].id] = 0;
+        // a slow tier that a later one made up for is not a timeout
+        if(!fact_empty(work[i].fact)) continue;
+        uf_fact_init(work[i].fact);
+        uf_fact_str(work[i].fact, "value", UF_TIMEOUT_TEXT);
+    }
+}
+
+const uf_fact_t* uf_registry_fact(uf_registry_t* reg, int id){
+    if(id < 0 || id >= UF_MOD_COUNT) return NULL;
+    if(!reg->ready[id]) uf_registry_collect(reg, &id, 1, 1);
+    return &reg->fact[id];
+}
+
+const char* uf_registry_value(uf_registry_t* reg, int id){
+    if(id < 0 || id >= UF_MOD_COUNT) return "";
+    const uf_fact_t* f = uf_registry_fact(reg, id);
+    if(!reg->shown[id]){
+        uf_module_text(id, f, reg->value[id], sizeof(reg->value[id]));
+        reg->shown[id] = 1;
+    }
+    return reg->value[id];
+}
+
+void uf_registry_finish(uf_registry_t* reg){
+    if(!reg->use_cache) return;
+    for(int i=0;i<UF_MOD_COUNT;i++){
+        // a timed-out probe says nothing about the next run
+        if(reg->missed[i] && !fact_timed_out(&reg->fact[i])){
+            char encoded[UF_FACT_TEXT_MAX];
+            uf_fact_encode(&reg->fact[i], encoded, sizeof(encoded));
+            uf_cache_put(uf_modules[i].key, reg->stamp[i], encoded);
+        }
+        reg->missed[i] = 0;
+    }
+    uf_cache_save();
+}
+
+void uf_registry_invalidate_volatile(uf_registry_t* reg){
+    for(int i=0;i<UF_MOD_COUNT;i++){
+        if(uf_modules[i].flags & UF_MOD_VOLATILE) reg->ready[i] = reg->shown[i] = 0;
+    }
+}
+
+size_t uf_registry_dump(const uf_registry_t* reg, char* out, size_t n){
+    size_t len = 0;
+    if(!out || n == 0) return 0;
+    out[0] = 0;
+    for(int i=0;i<UF_MOD_COUNT;i++){
+        if(!reg->ready[i]) continue;
+        char encoded[UF_FACT_TEXT_MAX];
+        uf_fact_encode(&reg->fact[i], encoded, sizeof(encoded));
+        int w = snprintf(out + len, n - len, "%s\t%s\n", uf_modules[i].key, encoded);
+        if(w < 0 || (size_t)w >= n - len){ out[len] = 0; break; }
+        len += (size_t)w;
+    }
+    return len;
+}
+
+int uf_registry_load(uf_registry_t* reg, const char* snapshot){
+    int loaded = 0;
+    const char* p = snapshot;
+    while(p && *p){
+        const char* tab = strchr(p, '\t');
+        const char* eol = strchr(p, '\n');
+        if(!eol) eol = p + strlen(p);
+        if(tab && tab < eol){
+            char key[32];
+            size_t klen = (size_t)(tab - p);
+            if(klen < sizeof(key)){
+                memcpy(key, p, klen);
+                key[klen] = 0;
+                int id = uf_module_find(key);
+                if(id >= 0){
+                    uf_fact_decode(&reg->fact[id], tab + 1, (size_t)(eol - tab - 1));
+                    reg->ready[id] = 1;
+                    reg->shown[id] = 0;
+                    loaded++;
+                }
+            }
+        }
+        p = *eol ? eol + 1 : eol;
+    }
+    return loaded;
+}
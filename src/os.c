@@ -1,5 +1,7 @@
 #include "common.h"
 #include "os.h"
+#include "props.h"
+#include "mapping.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -14,10 +16,6 @@
 typedef LONG (WINAPI *RtlGetVersionPtr)(PRTL_OSVERSIONINFOW);
 #endif
 
-#ifdef __ANDROID__
-#include <sys/system_properties.h>
-#endif
-
 /* ---------- utils ---------- */
 
 static void trim_newline(char* s) { 
@@ -40,31 +38,30 @@ static const char* arch_from_uname_machine(const char* m) {
 /* ---------- macOS helpers (native) ---------- */
 #ifdef __APPLE__
 static int read_plist_value(const char* path, const char* key, char* out, size_t outsz) {
-    FILE* f = fopen(path, "r");
-    if (!f) return 0;
+    char* plist = uf_read_file_alloc(path, NULL);
+    if (!plist) return 0;
     
-    char line[1024], want[256];
+    char want[256];
     snprintf(want, sizeof(want), "<key>%s</key>", key);
     int found = 0;
     
-    while (fgets(line, sizeof(line), f)) {
-        if (strstr(line, want)) {
-            if (fgets(line, sizeof(line), f)) {
-                char* s = strstr(line, "<string>");
-                char* e = strstr(line, "</string>");
-                if (s && e && e > s) {
-                    s += 8;
-                    size_t len = (size_t)(e - s);
-                    if (len >= outsz) len = outsz - 1;
-                    memcpy(out, s, len);
-                    out[len] = 0;
-                    found = 1;
-                    break;
-                }
-            }
+    char* k = strstr(plist, want);
+    if (k) {
+        char* next = strchr(k, '\n');
+        char* eol = next ? strchr(next + 1, '\n') : NULL;
+        if (eol) *eol = 0;
+        char* s = next ? strstr(next, "<string>") : NULL;
+        char* e = s ? strstr(s, "</string>") : NULL;
+        if (s && e) {
+            s += 8;
+            size_t len = (size_t)(e - s);
+            if (len >= outsz) len = outsz - 1;
+            memcpy(out, s, len);
+            out[len] = 0;
+            found = 1;
         }
     }
-    fclose(f);
+    free(plist);
     return found;
 }
 #endif
@@ -109,15 +106,15 @@ static void detect_windows(char* out, size_t n) {
 }
 
 static void detect_android(char* out, size_t n) {
-#ifdef __ANDROID__
+#if defined(__ANDROID__) || defined(__linux__)
     char ver[64] = {0};
     char codename[64] = {0};
 
-    __system_property_get("ro.build.version.release", ver);
-    __system_property_get("ro.build.version.codename", codename);
+    uf_prop_get("ro.build.version.release", ver, sizeof(ver));
+    uf_prop_get("ro.build.version.codename", codename, sizeof(codename));
 
     struct utsname uts;
-    uname(&uts);
+    uf_uname(&uts);
 
     snprintf(out, n, "Android %s %s %s",
              codename[0] ? codename : "REL",
@@ -129,13 +126,13 @@ static void detect_android(char* out, size_t n) {
 static void detect_linux(char* out, size_t n) {
 #ifdef __linux__
     struct utsname uts;
-    uname(&uts);
+    uf_uname(&uts);
     
-    FILE* fp = fopen("/etc/os-release", "r");
-    char line[512], pretty[256] = {0};
+    char buffer[4096], pretty[256] = {0};
     
-    if (fp) {
-        while (fgets(line, sizeof(line), fp)) {
+    if (uf_read_file("/etc/os-release", buffer, sizeof(buffer)) > 0) {
+        char *line, *rest = buffer;
+        while ((line = strsep(&rest, "\n")) != NULL) {
             if (!strncmp(line, "PRETTY_NAME=", 12)) {
                 char* q = strchr(line, '"');
                 if (q) {
@@ -150,7 +147,6 @@ static void detect_linux(char* out, size_t n) {
                 break;
             }
         }
-        fclose(fp);
     }
     
     if (pretty[0]) {
@@ -164,7 +160,7 @@ static void detect_linux(char* out, size_t n) {
 static void detect_bsd(char* out, size_t n) {
 #if defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__) || defined(__DragonFly__)
     struct utsname uts;
-    uname(&uts);
+    uf_uname(&uts);
     snprintf(out, n, "%s %s %s", uts.sysname, uts.release, arch_from_uname_machine(uts.machine));
 #endif
 }
@@ -172,7 +168,7 @@ static void detect_bsd(char* out, size_t n) {
 static void detect_macos(char* out, size_t n) {
 #ifdef __APPLE__
     struct utsname uts;
-    uname(&uts);
+    uf_uname(&uts);
 
     char productVer[64] = {0}, buildVer[64] = {0};
     int gotPV = read_plist_value("/System/Library/CoreServices/SystemVersion.plist", "ProductVersion", productVer, sizeof(productVer));
@@ -180,12 +176,19 @@ static void detect_macos(char* out, size_t n) {
 
     const char* arch = arch_from_uname_machine(uts.machine);
     
+    // "Sequoia 15" -> "Sequoia "; the version itself comes from the plist
+    char codename[32] = {0};
+    const char* release = uf_map_find_num(uf_map_macos, uf_map_macos_count,
+                                          (uint32_t)strtoul(uts.release, NULL, 10));
+    const char* space = release ? strrchr(release, ' ') : NULL;
+    if (space) snprintf(codename, sizeof(codename), "%.*s ", (int)(space - release), release);
+    
     if (gotPV && gotBV) {
-        snprintf(out, n, "macOS %s %s %s", productVer, buildVer, arch);
+        snprintf(out, n, "macOS %s%s %s %s", codename, productVer, buildVer, arch);
     } else if (gotPV) {
-        snprintf(out, n, "macOS %s %s", productVer, arch);
+        snprintf(out, n, "macOS %s%s %s", codename, productVer, arch);
     } else {
-        snprintf(out, n, "macOS (Darwin %s) %s", uts.release, arch);
+        snprintf(out, n, "macOS %s(Darwin %s) %s", codename, uts.release, arch);
     }
 #endif
 }
@@ -202,10 +205,29 @@ void os_string(char* out, size_t n) {
 #elif defined(__ANDROID__)
     detect_android(out, n);
 #elif defined(__linux__)
-    detect_linux(out, n);
+    if (UF_IS_ANDROID) detect_android(out, n);
+    else detect_linux(out, n);
 #elif defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__) || defined(__DragonFly__)
     detect_bsd(out, n);
 #else
     snprintf(out, n, "Unknown OS");
 #endif
 }
+
+void kernel_string(char* out, size_t n) {
+    if (!out || n == 0) return;
+    out[0] = 0;
+#if defined(__APPLE__) || defined(__linux__) || defined(__unix__) || defined(__ANDROID__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__) || defined(__DragonFly__)
+    struct utsname uts;
+    if (uf_uname(&uts) == 0) snprintf(out, n, "%s", uts.release);
+#endif
+}
+
+void arch_string(char* out, size_t n) {
+    if (!out || n == 0) return;
+    out[0] = 0;
+#if defined(__APPLE__) || defined(__linux__) || defined(__unix__) || defined(__ANDROID__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__) || defined(__DragonFly__)
+    struct utsname uts;
+    if (uf_uname(&uts) == 0) snprintf(out, n, "%s", uts.machine);
+#endif
+}
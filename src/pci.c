@@ -0,0 +1,53 @@
+// src/pci.c — single-pass enumeration of display-class PCI functions
+#include "common.h"
+#include "pci.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PCI_DEVICES "/sys/bus/pci/devices"
+
+static unsigned long read_hex(const char* slot, const char* attr, int* ok){
+    char path[64], buf[32];
+    snprintf(path, sizeof(path), "%s/%s", slot, attr);
+    *ok = uf_read_value(PCI_DEVICES, path, buf, sizeof(buf));
+    return *ok ? strtoul(buf, NULL, 16) : 0;
+}
+
+static void read_driver(const char* slot, char* out, size_t n){
+    char path[128], target[256];
+    snprintf(path, sizeof(path), PCI_DEVICES "/%s/driver", slot);
+    out[0] = 0;
+    if(uf_readlink(path, target, sizeof(target)) <= 0) return;
+    const char* base = strrchr(target, '/');
+    snprintf(out, n, "%.*s", (int)n - 1, base ? base + 1 : target);
+}
+
+size_t uf_pci_display(uf_pci_dev_t* out, size_t max){
+    uf_dir_t* dir = uf_dir_open(PCI_DEVICES);
+    if(!dir) return 0;
+
+    size_t count = 0;
+    const char* name;
+    while(count < max && (name = uf_dir_next(dir, NULL)) != NULL){
+        if(strlen(name) >= sizeof(out->slot)) continue;
+        int ok;
+        // class first: most functions on the bus are not display devices
+        unsigned long cls = read_hex(name, "class", &ok);
+        if(!ok || (cls >> 16) != UF_PCI_CLASS_DISPLAY) continue;
+
+        uf_pci_dev_t* d = &out[count];
+        memset(d, 0, sizeof(*d));
+        snprintf(d->slot, sizeof(d->slot), "%s", name);
+        d->vendor = (uint16_t)read_hex(name, "vendor", &ok);
+        if(!ok) continue;
+        d->device = (uint16_t)read_hex(name, "device", &ok);
+        d->subsystem_vendor = (uint16_t)read_hex(name, "subsystem_vendor", &ok);
+        d->subsystem_device = (uint16_t)read_hex(name, "subsystem_device", &ok);
+        d->boot_vga = read_hex(name, "boot_vga", &ok) == 1;
+        read_driver(name, d->driver, sizeof(d->driver));
+        count++;
+    }
+    uf_dir_close(dir);
+    return count;
+}
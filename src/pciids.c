@@ -0,0 +1,265 @@
+// src/pciids.c — pci.ids names through a compact, cached binary index
+#include "common.h"
+#include "pciids.h"
+#include "cache.h"
+#include "record.h"
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#define IDX_MAGIC "xfpciid1"
+#define IDX_FILE "pci.ids.idx"
+
+enum { LEVEL_VENDOR, LEVEL_DEVICE, LEVEL_SUBSYSTEM };
+
+// On disk: header, entries sorted by (vendor, device, subvendor, subdevice,
+// level), then the NUL-terminated names the entries point at.
+typedef struct {
+    char magic[8];
+    uint64_t src_ino;         // the pci.ids this was built from
+    int64_t src_mtime_ns;
+    uint64_t src_size;
+    uint32_t count;
+    uint32_t names_off;       // byte offset of the name pool
+} idx_header_t;
+
+typedef struct {
+    uint16_t vendor, device, subvendor, subdevice;
+    uint32_t level;
+    uint32_t name;            // offset into the name pool
+} idx_entry_t;
+
+static const char* const ids_paths[] = {
+    "/usr/share/hwdata/pci.ids",
+    "/usr/share/misc/pci.ids",
+    "/usr/share/pci.ids",
+    NULL
+};
+
+static pthread_once_t idx_once = PTHREAD_ONCE_INIT;
+static const idx_header_t* idx;
+static size_t idx_len;
+
+static int entry_cmp(const idx_entry_t* a, const idx_entry_t* b){
+    if(a->vendor != b->vendor) return a->vendor < b->vendor ? -1 : 1;
+    if(a->device != b->device) return a->device < b->device ? -1 : 1;
+    if(a->subvendor != b->subvendor) return a->subvendor < b->subvendor ? -1 : 1;
+    if(a->subdevice != b->subdevice) return a->subdevice < b->subdevice ? -1 : 1;
+    return a->level < b->level ? -1 : a->level > b->level;
+}
+
+static int entry_qsort(const void* a, const void* b){
+    return entry_cmp(a, b);
+}
+
+static int hex4(const char* p, const char* end, uint16_t* out){
+    if(end - p < 4) return 0;
+    unsigned v = 0;
+    for(int i = 0; i < 4; i++){
+        char c = p[i];
+        v <<= 4;
+        if(c >= '0' && c <= '9') v |= (unsigned)(c - '0');
+        else if(c >= 'a' && c <= 'f') v |= (unsigned)(c - 'a' + 10);
+        else if(c >= 'A' && c <= 'F') v |= (unsigned)(c - 'A' + 10);
+        else return 0;
+    }
+    *out = (uint16_t)v;
+    return 1;
+}
+
+// pci.ids text into a malloc'd index image; NULL on failure or no entries.
+static idx_header_t* build(const char* text, size_t len, size_t* out_len){
+    idx_entry_t* entries = NULL;
+    size_t count = 0, cap = 0;
+    char* names = malloc(len + 1);
+    size_t names_len = 0;
+    if(!names) return NULL;
+
+    uint16_t vendor = 0, device = 0;
+    int have_vendor = 0, have_device = 0;
+    const char* end = text + len;
+    for(const char* line = text; line < end; ){
+        const char* eol = memchr(line, '\n', (size_t)(end - line));
+        if(!eol) eol = end;
+        const char* p = line;
+        line = eol + 1;
+
+        int tabs = 0;
+        while(p < eol && *p == '\t' && tabs < 2){ p++; tabs++; }
+        if(p == eol || *p == '#') continue;
+        // the device class section follows the vendors; nothing we need there
+        if(tabs == 0 && *p == 'C' && p + 1 < eol && p[1] == ' ') break;
+
+        idx_entry_t e = {0};
+        if(tabs == 0){
+            if(!hex4(p, eol, &vendor)){ have_vendor = 0; continue; }
+            have_vendor = 1;
+            have_device = 0;
+            e.vendor = vendor;
+            e.level = LEVEL_VENDOR;
+            p += 4;
+        } else if(tabs == 1){
+            if(!have_vendor || !hex4(p, eol, &device)){ have_device = 0; continue; }
+            have_device = 1;
+            e.vendor = vendor;
+            e.device = device;
+            e.level = LEVEL_DEVICE;
+            p += 4;
+        } else {
+            if(!have_device || !hex4(p, eol, &e.subvendor) ||
+               p + 5 > eol || !hex4(p + 5, eol, &e.subdevice)) continue;
+            e.vendor = vendor;
+            e.device = device;
+            e.level = LEVEL_SUBSYSTEM;
+            p += 9;
+        }
+        while(p < eol && (*p == ' ' || *p == '\t')) p++;
+        const char* q = eol;
+        while(q > p && (q[-1] == ' ' || q[-1] == '\r')) q--;
+        if(q == p) continue;
+
+        if(count == cap){
+            cap = cap ? cap * 2 : 4096;
+            idx_entry_t* grown = realloc(entries, cap * sizeof(*entries));
+            if(!grown){ free(entries); free(names); return NULL; }
+            entries = grown;
+        }
+        e.name = (uint32_t)names_len;
+        memcpy(names + names_len, p, (size_t)(q - p));
+        names_len += (size_t)(q - p);
+        names[names_len++] = 0;
+        entries[count++] = e;
+    }
+
+    idx_header_t* img = NULL;
+    if(count){
+        qsort(entries, count, sizeof(*entries), entry_qsort);
+        size_t names_off = sizeof(idx_header_t) + count * sizeof(idx_entry_t);
+        *out_len = names_off + names_len;
+        img = calloc(1, *out_len);
+        if(img){
+            memcpy(img->magic, IDX_MAGIC, sizeof(img->magic));
+            img->count = (uint32_t)count;
+            img->names_off = (uint32_t)names_off;
+            memcpy(img + 1, entries, count * sizeof(*entries));
+            memcpy((char*)img + names_off, names, names_len);
+        }
+    }
+    free(entries);
+    free(names);
+    return img;
+}
+
+static int valid(const idx_header_t* h, size_t len){
+    if(len < sizeof(*h) || memcmp(h->magic, IDX_MAGIC, sizeof(h->magic)) != 0) return 0;
+    size_t names_off = sizeof(*h) + (size_t)h->count * sizeof(idx_entry_t);
+    return h->names_off == names_off && names_off < len && ((const char*)h)[len - 1] == 0;
+}
+
+static int same_source(const idx_header_t* h, const struct stat* st){
+    return h->src_ino == (uint64_t)st->st_ino && h->src_size == (uint64_t)st->st_size &&
+           h->src_mtime_ns == (int64_t)st->st_mtim.tv_sec * 1000000000 + st->st_mtim.tv_nsec;
+}
+
+static const idx_header_t* map_index(const char* path, const struct stat* src, size_t* len){
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if(fd < 0) return NULL;
+    struct stat st;
+    void* map = MAP_FAILED;
+    if(fstat(fd, &st) == 0 && st.st_size > 0)
+        map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED) return NULL;
+    if(!valid(map, (size_t)st.st_size) || !same_source(map, src)){
+        munmap(map, (size_t)st.st_size);
+        return NULL;
+    }
+    *len = (size_t)st.st_size;
+    return map;
+}
+
+static void save_index(const char* path, idx_header_t* img, size_t len, const struct stat* src){
+    img->src_ino = (uint64_t)src->st_ino;
+    img->src_size = (uint64_t)src->st_size;
+    img->src_mtime_ns = (int64_t)src->st_mtim.tv_sec * 1000000000 + src->st_mtim.tv_nsec;
+
+    char tmp[640];
+    snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", path, (long)getpid());
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if(fd < 0) return;
+    ssize_t w = write(fd, img, len);
+    if(close(fd) != 0 || w != (ssize_t)len || rename(tmp, path) != 0) unlink(tmp);
+}
+
+static void load(void){
+    UF_TRACE_BEGIN("pciids");
+    // the on-disk index describes this machine's pci.ids, so it is only
+    // used (and written) for live runs; --no-cache leaves uf_cache_dir empty
+    int live = !uf_sysroot()[0] && UF_SNAP_MODE == UF_SNAP_OFF;
+    char dir[512], path[600];
+    struct stat src;
+
+    for(int i = 0; ids_paths[i]; i++){
+        if(uf_access(ids_paths[i], R_OK) != 0) continue;
+        int cached = live && stat(ids_paths[i], &src) == 0 && uf_cache_dir(dir, sizeof(dir), 0);
+        if(cached){
+            snprintf(path, sizeof(path), "%s/" IDX_FILE, dir);
+            if((idx = map_index(path, &src, &idx_len))) break;
+        }
+
+        size_t len;
+        const char* text = uf_map_file(ids_paths[i], &len);
+        if(!text) continue;
+        idx_header_t* img = build(text, len, &idx_len);
+        uf_unmap_file(text, len);
+        if(!img) continue;
+        if(cached && uf_cache_dir(dir, sizeof(dir), 1)) save_index(path, img, idx_len, &src);
+        idx = img;
+        break;
+    }
+    UF_TRACE_END();
+}
+
+static int lookup(const idx_entry_t* key, char* out, size_t n){
+    pthread_once(&idx_once, load);
+    if(!idx || !out || n == 0) return 0;
+
+    const idx_entry_t* entries = (const idx_entry_t*)(idx + 1);
+    size_t lo = 0, hi = idx->count;
+    while(lo < hi){
+        size_t mid = lo + (hi - lo) / 2;
+        int c = entry_cmp(&entries[mid], key);
+        if(c == 0){
+            const char* name = (const char*)idx + idx->names_off + entries[mid].name;
+            if(name >= (const char*)idx + idx_len) return 0;
+            snprintf(out, n, "%s", name);
+            return 1;
+        }
+        if(c < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return 0;
+}
+
+int uf_pciids_vendor(uint16_t vendor, char* out, size_t n){
+    idx_entry_t key = { .vendor = vendor, .level = LEVEL_VENDOR };
+    return lookup(&key, out, n);
+}
+
+int uf_pciids_device(uint16_t vendor, uint16_t device, char* out, size_t n){
+    idx_entry_t key = { .vendor = vendor, .device = device, .level = LEVEL_DEVICE };
+    return lookup(&key, out, n);
+}
+
+int uf_pciids_subsystem(uint16_t vendor, uint16_t device,
+                        uint16_t subvendor, uint16_t subdevice, char* out, size_t n){
+    idx_entry_t key = { .vendor = vendor, .device = device, .subvendor = subvendor,
+                        .subdevice = subdevice, .level = LEVEL_SUBSYSTEM };
+    return lookup(&key, out, n);
+}
@@ -0,0 +1,59 @@
+// src/pool.c — tiny fixed-size worker pool for module collection
+#include "common.h"
+#include "pool.h"
+#include "trace.h"
+#include <pthread.h>
+#include <stdio.h>
+
+typedef struct {
+    uf_task_t* tasks;
+    size_t count;
+    size_t next;
+    pthread_mutex_t lock;
+} uf_pool_t;
+
+static void run_task(uf_task_t* t){
+    UF_TRACE_BEGIN(t->name ? t->name : "task");
+    uf_deadline_begin(t->deadline_ms);
+    t->fn(t->arg);
+    t->timed_out = uf_deadline_hit();
+    UF_TRACE_END();
+}
+
+static void* pool_worker(void* arg){
+    uf_pool_t* pool = arg;
+    for(;;){
+        pthread_mutex_lock(&pool->lock);
+        size_t i = pool->next < pool->count ? pool->next++ : pool->count;
+        pthread_mutex_unlock(&pool->lock);
+        if(i >= pool->count) break;
+        run_task(&pool->tasks[i]);
+    }
+    return NULL;
+}
+
+void uf_pool_run(uf_task_t* tasks, size_t count, int workers){
+    if(!tasks || count == 0) return;
+    if(workers > UF_POOL_MAX_WORKERS) workers = UF_POOL_MAX_WORKERS;
+    if((size_t)workers > count) workers = (int)count;
+
+    if(workers <= 1){
+        for(size_t i=0;i<count;i++) run_task(&tasks[i]);
+        return;
+    }
+
+    uf_pool_t pool = { .tasks = tasks, .count = count, .next = 0 };
+    pthread_mutex_init(&pool.lock, NULL);
+
+    pthread_t tid[UF_POOL_MAX_WORKERS];
+    int started = 0;
+    for(int i=0;i<workers;i++){
+        if(pthread_create(&tid[i], NULL, pool_worker, &pool) != 0) break;
+        started++;
+    }
+    // if thread creation failed, drain the remaining tasks here
+    if(started < workers) pool_worker(&pool);
+
+    for(int i=0;i<started;i++) pthread_join(tid[i], NULL);
+    pthread_mutex_destroy(&pool.lock);
+}
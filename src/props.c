@@ -0,0 +1,139 @@
+// src/props.c — build.prop index and __system_property_get wrapper
+#include "common.h"
+#include "props.h"
+#include "record.h"
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#ifdef __ANDROID__
+#include <sys/system_properties.h>
+#endif
+
+typedef struct {
+    const char* key;     // NULL = empty slot
+    const char* value;
+    uint32_t key_len;
+    uint32_t value_len;
+} prop_slot_t;
+
+static const char* const prop_files[] = {
+    "/system/build.prop",
+    "/vendor/build.prop",
+    "/odm/etc/build.prop",
+};
+#define PROP_FILES (sizeof(prop_files) / sizeof(prop_files[0]))
+
+static pthread_once_t prop_once = PTHREAD_ONCE_INIT;
+static prop_slot_t* prop_table;
+static size_t prop_mask;
+
+static uint32_t prop_hash(const char* s, size_t n){
+    uint32_t h = 2166136261u;   // FNV-1a
+    for(size_t i=0;i<n;i++){ h ^= (unsigned char)s[i]; h *= 16777619u; }
+    return h;
+}
+
+static int is_blank(char c){
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Calls fn for every "key=value" line; comments, imports and junk are skipped.
+static void prop_scan(const char* p, size_t len, void (*fn)(const char*, size_t, const char*, size_t)){
+    const char* end = p + len;
+    while(p < end){
+        const char* eol = memchr(p, '\n', (size_t)(end - p));
+        if(!eol) eol = end;
+        const char* k = p;
+        while(k < eol && is_blank(*k)) k++;
+        const char* eq = k < eol && *k != '#' ? memchr(k, '=', (size_t)(eol - k)) : NULL;
+        if(eq && eq > k){
+            const char* ke = eq;
+            while(ke > k && is_blank(ke[-1])) ke--;
+            const char* v = eq + 1;
+            const char* ve = eol;
+            while(v < ve && is_blank(*v)) v++;
+            while(ve > v && is_blank(ve[-1])) ve--;
+            fn(k, (size_t)(ke - k), v, (size_t)(ve - v));
+        }
+        p = eol < end ? eol + 1 : end;
+    }
+}
+
+static size_t prop_lines;
+
+static void count_line(const char* k, size_t kn, const char* v, size_t vn){
+    (void)k; (void)kn; (void)v; (void)vn;
+    prop_lines++;
+}
+
+static void insert_line(const char* k, size_t kn, const char* v, size_t vn){
+    for(size_t i = prop_hash(k, kn) & prop_mask;; i = (i + 1) & prop_mask){
+        prop_slot_t* s = &prop_table[i];
+        if(!s->key){
+            s->key = k;
+            s->key_len = (uint32_t)kn;
+            s->value = v;
+            s->value_len = (uint32_t)vn;
+            return;
+        }
+        if(s->key_len == kn && memcmp(s->key, k, kn) == 0) return;   // first one wins
+    }
+}
+
+static void prop_build(void){
+    UF_TRACE_BEGIN("props");
+    const char* data[PROP_FILES];
+    size_t len[PROP_FILES];
+    for(size_t f=0;f<PROP_FILES;f++){
+        data[f] = uf_map_file(prop_files[f], &len[f]);
+        if(data[f]) prop_scan(data[f], len[f], count_line);
+    }
+    if(prop_lines){
+        // at most half full, so probes stay short
+        size_t cap = 16;
+        while(cap < prop_lines * 2) cap *= 2;
+        prop_table = calloc(cap, sizeof(*prop_table));
+        prop_mask = cap - 1;
+    }
+    for(size_t f=0;prop_table && f<PROP_FILES;f++)
+        if(data[f]) prop_scan(data[f], len[f], insert_line);
+    UF_TRACE_END();
+}
+
+static int prop_lookup(const char* key, char* out, size_t n){
+    pthread_once(&prop_once, prop_build);
+    if(!prop_table) return 0;
+    size_t kn = strlen(key);
+    for(size_t i = prop_hash(key, kn) & prop_mask; prop_table[i].key; i = (i + 1) & prop_mask){
+        const prop_slot_t* s = &prop_table[i];
+        if(s->key_len != kn || memcmp(s->key, key, kn) != 0) continue;
+        if(s->value_len == 0) return 0;
+        size_t m = s->value_len < n - 1 ? s->value_len : n - 1;
+        memcpy(out, s->value, m);
+        out[m] = 0;
+        return 1;
+    }
+    return 0;
+}
+
+int uf_prop_get(const char* key, char* out, size_t n){
+    if(!key || !out || n == 0) return 0;
+    out[0] = 0;
+#ifdef __ANDROID__
+    // the live property area also has the values init sets at boot
+    // (ro.hardware, ro.serialno, ...), which no build.prop carries; a
+    // sysroot or snapshot only ever sees the files
+    if(!uf_sysroot()[0] && UF_SNAP_MODE == UF_SNAP_OFF){
+        char value[PROP_VALUE_MAX];
+        if(__system_property_get(key, value) > 0){
+            snprintf(out, n, "%s", value);
+            return 1;
+        }
+    }
+#endif
+    return prop_lookup(key, out, n);
+}
@@ -1,6 +1,7 @@
 // src/ram.c
 #include "common.h"
 #include "ram.h"
+#include "fact.h"
 #include <sys/sysinfo.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -35,13 +36,14 @@ static unsigned long long parse_meminfo_value(const char* line) {
 }
 
 static int parse_meminfo(ram_info_t* info) {
-    FILE* f = fopen(MEMINFO_PATH, "r");
-    if (!f) return 0;
+    // the fields we want are all in the first few lines
+    char content[2048];
+    if (uf_read_file(MEMINFO_PATH, content, sizeof(content)) <= 0) return 0;
     
-    char buffer[256];
+    char *buffer, *rest = content;
     memset(info, 0, sizeof(*info));
     
-    while (fgets(buffer, sizeof(buffer), f)) {
+    while ((buffer = strsep(&rest, "\n")) != NULL) {
         if (strncmp(buffer, "MemTotal:", 9) == 0) {
             info->total = parse_meminfo_value(buffer);
         } else if (strncmp(buffer, "MemFree:", 8) == 0) {
@@ -55,8 +57,6 @@ static int parse_meminfo(ram_info_t* info) {
         }
     }
     
-    fclose(f);
-    
     if (info->available > 0) {
         info->used = info->total - info->available;
     } else {
@@ -71,7 +71,7 @@ static int parse_meminfo(ram_info_t* info) {
 
 static int parse_sysinfo(ram_info_t* info) {
     struct sysinfo si;
-    if (sysinfo(&si) != 0) return 0;
+    if (uf_sysinfo(&si) != 0) return 0;
     
     memset(info, 0, sizeof(*info));
     info->total = (unsigned long long)si.totalram * si.mem_unit;
@@ -89,18 +89,29 @@ static int get_ram_info(ram_info_t* info) {
     return parse_sysinfo(info);
 }
 
-void ram_string(char* out, size_t n) {
+void ram_fact(uf_fact_t* f) {
+    ram_info_t info;
+    if (!get_ram_info(&info)) return;
+    
+    uf_fact_int(f, "total", UF_FACT_BYTES, (long long)info.total);
+    uf_fact_int(f, "used", UF_FACT_BYTES, (long long)info.used);
+    uf_fact_int(f, "available", UF_FACT_BYTES, (long long)(info.available > 0 ? info.available : info.free));
+    uf_fact_int(f, "cached", UF_FACT_BYTES, (long long)info.cached);
+    uf_fact_int(f, "buffers", UF_FACT_BYTES, (long long)info.buffers);
+}
+
+void ram_text(const uf_fact_t* f, char* out, size_t n) {
     if (!out || n == 0) return;
     
-    ram_info_t info;
-    if (get_ram_info(&info)) {
-        char used_str[32], total_str[32];
-        uf_human_bytes(info.used, used_str);
-        uf_human_bytes(info.total, total_str);
-        snprintf(out, n, "%s / %s", used_str, total_str);
-    } else {
+    long long total = uf_fact_get_int(f, "total", -1);
+    if (total < 0) {
         snprintf(out, n, "N/A");
+        return;
     }
+    char used_str[32], total_str[32];
+    uf_human_bytes((unsigned long long)uf_fact_get_int(f, "used", 0), used_str);
+    uf_human_bytes((unsigned long long)total, total_str);
+    snprintf(out, n, "%s / %s", used_str, total_str);
 }
 
 void ram_usage_percent(char* out, size_t n) {
@@ -210,7 +221,7 @@ DETECTION HIERARCHY:
 2. sysinfo() syscall - Fallback method, always available
 
 KEY FUNCTIONS:
-- ram_string(): Basic "used / total" format
+- ram_fact() / ram_text(): byte counts, rendered as "used / total"
 - ram_usage_percent(): Percentage utilization
 - ram_available_string(): Available memory amount
 - ram_pressure_level(): Memory pressure classification
@@ -0,0 +1,216 @@
+#include "common.h"
+#include "record.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SNAP_MAGIC "XFSNAP1"
+
+typedef struct {
+    char magic[8];
+    uint32_t count;
+    uint32_t reserved;
+    uint64_t string_off;
+    uint64_t blob_off;
+} snap_header_t;
+
+typedef struct {
+    uint32_t kind;
+    uint32_t flags;
+    uint32_t key_off;
+    uint32_t key_len;
+    uint64_t data_off;
+    uint64_t data_len;
+} snap_entry_t;
+
+int UF_SNAP_MODE = UF_SNAP_OFF;
+
+// recording: observations stay in memory until uf_snap_finish
+typedef struct {
+    int kind;
+    int missing;
+    char* key;
+    char* data;
+    size_t len;
+} rec_item_t;
+
+static pthread_mutex_t rec_lock = PTHREAD_MUTEX_INITIALIZER;
+static rec_item_t* rec_items;
+static size_t rec_count, rec_cap;
+static char rec_path[4096];
+
+// replaying: the archive, mapped read-only
+static const unsigned char* map_base;
+static size_t map_len;
+static const snap_entry_t* map_entries;
+static uint32_t map_count;
+
+int uf_snap_record(const char* path){
+    if(!path || !*path) return -1;
+    snprintf(rec_path, sizeof(rec_path), "%s", path);
+    UF_SNAP_MODE = UF_SNAP_RECORD;
+    return 0;
+}
+
+const char* uf_snap_put(int kind, const char* key, const void* data, size_t len, int missing){
+    static const char empty[1];
+    const char* stored = NULL;
+
+    pthread_mutex_lock(&rec_lock);
+    for(size_t i=0;i<rec_count;i++){
+        if(rec_items[i].kind == kind && strcmp(rec_items[i].key, key) == 0){
+            stored = rec_items[i].missing ? NULL : (rec_items[i].data ? rec_items[i].data : empty);
+            pthread_mutex_unlock(&rec_lock);
+            return stored;
+        }
+    }
+    if(rec_count == rec_cap){
+        size_t cap = rec_cap ? rec_cap * 2 : 256;
+        rec_item_t* grown = realloc(rec_items, cap * sizeof(*grown));
+        if(!grown){ pthread_mutex_unlock(&rec_lock); return missing ? NULL : data; }
+        rec_items = grown;
+        rec_cap = cap;
+    }
+    rec_item_t* it = &rec_items[rec_count];
+    it->kind = kind;
+    it->missing = missing;
+    it->key = strdup(key);
+    it->len = missing ? 0 : len;
+    it->data = NULL;
+    if(it->len){
+        it->data = malloc(it->len);
+        if(it->data) memcpy(it->data, data, it->len);
+    }
+    if(it->key && (!it->len || it->data)){
+        rec_count++;
+        stored = missing ? NULL : (it->data ? it->data : empty);
+    } else {
+        free(it->key);
+        free(it->data);
+        stored = missing ? NULL : data;
+    }
+    pthread_mutex_unlock(&rec_lock);
+    return stored;
+}
+
+static int rec_cmp(const void* a, const void* b){
+    const rec_item_t* x = a;
+    const rec_item_t* y = b;
+    if(x->kind != y->kind) return x->kind < y->kind ? -1 : 1;
+    return strcmp(x->key, y->key);
+}
+
+int uf_snap_finish(void){
+    if(UF_SNAP_MODE != UF_SNAP_RECORD) return 0;
+
+    pthread_mutex_lock(&rec_lock);
+    qsort(rec_items, rec_count, sizeof(*rec_items), rec_cmp);
+
+    snap_header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, SNAP_MAGIC, sizeof(SNAP_MAGIC));
+    hdr.count = (uint32_t)rec_count;
+    hdr.string_off = sizeof(hdr) + rec_count * sizeof(snap_entry_t);
+
+    uint64_t strings = 0;
+    for(size_t i=0;i<rec_count;i++) strings += strlen(rec_items[i].key) + 1;
+    hdr.blob_off = hdr.string_off + strings;
+
+    char tmp[4096 + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", rec_path);
+    FILE* f = fopen(tmp, "wb");
+    int ok = f != NULL;
+    if(ok) ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+
+    uint64_t key_off = hdr.string_off, data_off = hdr.blob_off;
+    for(size_t i=0;ok && i<rec_count;i++){
+        snap_entry_t e;
+        e.kind = (uint32_t)rec_items[i].kind;
+        e.flags = rec_items[i].missing ? UF_SNAP_MISSING : 0;
+        e.key_len = (uint32_t)strlen(rec_items[i].key);
+        e.key_off = (uint32_t)key_off;
+        e.data_off = data_off;
+        e.data_len = rec_items[i].len;
+        key_off += e.key_len + 1;
+        data_off += e.data_len;
+        ok = fwrite(&e, sizeof(e), 1, f) == 1;
+    }
+    for(size_t i=0;ok && i<rec_count;i++)
+        ok = fwrite(rec_items[i].key, strlen(rec_items[i].key) + 1, 1, f) == 1;
+    for(size_t i=0;ok && i<rec_count;i++)
+        if(rec_items[i].len) ok = fwrite(rec_items[i].data, rec_items[i].len, 1, f) == 1;
+
+    if(f && fclose(f) != 0) ok = 0;
+    if(ok) ok = rename(tmp, rec_path) == 0;
+    if(!ok){
+        unlink(tmp);
+        fprintf(stderr, "ultrafetch: cannot write %s: %s\n", rec_path, strerror(errno));
+    }
+    pthread_mutex_unlock(&rec_lock);
+    return ok ? 0 : -1;
+}
+
+int uf_snap_replay(const char* path){
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if(fd < 0) return -1;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(snap_header_t)){ close(fd); return -1; }
+    void* base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(base == MAP_FAILED) return -1;
+
+    const snap_header_t* hdr = base;
+    size_t len = (size_t)st.st_size;
+    uint64_t table_end = sizeof(*hdr) + (uint64_t)hdr->count * sizeof(snap_entry_t);
+    int ok = memcmp(hdr->magic, SNAP_MAGIC, sizeof(SNAP_MAGIC)) == 0 &&
+             table_end <= hdr->string_off && hdr->string_off <= hdr->blob_off && hdr->blob_off <= len;
+
+    // bounds-check once so lookups can trust the table (data_off + data_len
+    // can wrap, so the length is checked against what is left instead)
+    const snap_entry_t* entries = (const snap_entry_t*)((const unsigned char*)base + sizeof(*hdr));
+    for(uint32_t i=0;ok && i<hdr->count;i++){
+        const snap_entry_t* e = &entries[i];
+        ok = e->key_off >= hdr->string_off && (uint64_t)e->key_off + e->key_len < hdr->blob_off &&
+             e->data_off >= hdr->blob_off && e->data_off <= len && e->data_len <= len - e->data_off &&
+             ((const char*)base)[e->key_off + e->key_len] == 0;
+    }
+    if(!ok){ munmap(base, len); errno = EINVAL; return -1; }
+
+    map_base = base;
+    map_len = len;
+    map_entries = entries;
+    map_count = hdr->count;
+    UF_SNAP_MODE = UF_SNAP_REPLAY;
+    return 0;
+}
+
+int uf_snap_get(int kind, const char* key, const char** data, size_t* len){
+    size_t klen = strlen(key);
+    uint32_t lo = 0, hi = map_count;
+    while(lo < hi){
+        uint32_t mid = lo + (hi - lo) / 2;
+        const snap_entry_t* e = &map_entries[mid];
+        int c = (int)e->kind - kind;
+        if(c == 0){
+            size_t m = e->key_len < klen ? e->key_len : klen;
+            c = memcmp(map_base + e->key_off, key, m);
+            if(c == 0) c = e->key_len < klen ? -1 : (e->key_len > klen ? 1 : 0);
+        }
+        if(c == 0){
+            if(e->flags & UF_SNAP_MISSING) return 0;
+            *data = (const char*)map_base + e->data_off;
+            *len = (size_t)e->data_len;
+            return 1;
+        }
+        if(c < 0) lo = mid + 1; else hi = mid;
+    }
+    return 0;
+}
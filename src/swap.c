@@ -4,16 +4,19 @@
 #include <sys/sysinfo.h>
 #include <stdio.h>
 
-void swap_string(char* out, size_t n){
+void swap_fact(uf_fact_t* f){
     struct sysinfo si;
-    if(sysinfo(&si)==0){
-        unsigned long long total = (unsigned long long)si.totalswap * si.mem_unit;
-        unsigned long long freeb = (unsigned long long)si.freeswap * si.mem_unit;
-        unsigned long long used = total - freeb;
-        char a[32], b[32];
-        uf_human_bytes(used, a); uf_human_bytes(total, b);
-        snprintf(out,n,"%s / %s", a, b);
-    }else{
-        snprintf(out,n,"N/A");
-    }
+    if(uf_sysinfo(&si)!=0) return;
+    unsigned long long total = (unsigned long long)si.totalswap * si.mem_unit;
+    unsigned long long freeb = (unsigned long long)si.freeswap * si.mem_unit;
+    uf_fact_int(f, "total", UF_FACT_BYTES, (long long)total);
+    uf_fact_int(f, "used", UF_FACT_BYTES, (long long)(total - freeb));
+}
+
+void swap_text(const uf_fact_t* f, char* out, size_t n){
+    long long total = uf_fact_get_int(f, "total", -1);
+    if(total < 0){ snprintf(out,n,"N/A"); return; }
+    char a[32], b[32];
+    uf_human_bytes((unsigned long long)uf_fact_get_int(f, "used", 0), a); uf_human_bytes((unsigned long long)total, b);
+    snprintf(out,n,"%s / %s", a, b);
 }
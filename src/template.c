@@ -0,0 +1,219 @@
+// src/template.c — compiled single-line output templates
+#include "common.h"
+#include "template.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum { TPL_TEXT, TPL_VALUE, TPL_FIELD, TPL_COLOR };
+
+static const struct {
+    const char* name;
+    const char* ansi;
+} palette[] = {
+    { "reset",   "\033[0m" },
+    { "bold",    "\033[1m" },
+    { "dim",     "\033[2m" },
+    { "red",     "\033[31m" },
+    { "green",   "\033[32m" },
+    { "yellow",  "\033[33m" },
+    { "blue",    "\033[34m" },
+    { "magenta", "\033[35m" },
+    { "cyan",    "\033[36m" },
+    { "white",   "\033[37m" },
+};
+
+static uf_tpl_op_t* tpl_push(uf_template_t* t, int op){
+    if(t->count >= UF_TPL_OPS) return NULL;
+    uf_tpl_op_t* o = &t->op[t->count++];
+    memset(o, 0, sizeof(*o));
+    o->op = (unsigned char)op;
+    o->precision = -1;
+    return o;
+}
+
+static int tpl_text(uf_template_t* t, size_t off, size_t len){
+    if(len == 0) return 0;
+    uf_tpl_op_t* o = tpl_push(t, TPL_TEXT);
+    if(!o) return -1;
+    o->off = (unsigned short)off;
+    o->len = (unsigned short)len;
+    return 0;
+}
+
+// "[-]width[.precision]"
+static int tpl_spec(uf_tpl_op_t* o, const char* s){
+    if(*s == '-'){ o->left = 1; s++; }
+    char* end;
+    long width = strtol(s, &end, 10);
+    if(end != s){
+        if(width < 0 || width > 255) return -1;
+        o->width = (short)width;
+        s = end;
+    }
+    if(*s == '.'){
+        long prec = strtol(s + 1, &end, 10);
+        if(end == s + 1 || prec < 0 || prec > 64) return -1;
+        o->precision = (short)prec;
+        s = end;
+    }
+    return *s ? -1 : 0;
+}
+
+static void tpl_use(uf_template_t* t, int id){
+    for(size_t i=0;i<t->id_count;i++) if(t->ids[i] == id) return;
+    t->ids[t->id_count++] = id;
+}
+
+// One "{...}" body, NUL terminated in place inside t->src.
+static int tpl_ref(uf_template_t* t, char* body, char* err, size_t errn){
+    if(body[0] == '#'){
+        for(size_t i=0;i<sizeof(palette)/sizeof(palette[0]);i++){
+            if(strcmp(body + 1, palette[i].name) != 0) continue;
+            uf_tpl_op_t* o = tpl_push(t, TPL_COLOR);
+            if(!o) break;
+            o->color = (unsigned char)i;
+            return 0;
+        }
+        snprintf(err, errn, "unknown colour '%s'", body + 1);
+        return -1;
+    }
+
+    char* spec = strchr(body, ':');
+    if(spec) *spec++ = 0;
+    char* field = strchr(body, '.');
+    if(field) *field++ = 0;
+
+    int id = uf_module_find(body);
+    if(id < 0){
+        snprintf(err, errn, "unknown module '%s'", body);
+        return -1;
+    }
+    if(field && !uf_module_has_field(id, field)){
+        snprintf(err, errn, "unknown field '%s.%s'", body, field);
+        return -1;
+    }
+    int is_value = !field || strcmp(field, "value") == 0;
+    uf_tpl_op_t* o = tpl_push(t, is_value ? TPL_VALUE : TPL_FIELD);
+    if(!o){
+        snprintf(err, errn, "more than %d parts", UF_TPL_OPS);
+        return -1;
+    }
+    o->module = (unsigned char)id;
+    if(field){
+        o->off = (unsigned short)(field - t->src);
+        o->len = (unsigned short)strlen(field);
+    }
+    if(spec && tpl_spec(o, spec) != 0){
+        snprintf(err, errn, "bad width/precision ':%s'", spec);
+        return -1;
+    }
+    tpl_use(t, id);
+    return 0;
+}
+
+int uf_template_compile(uf_template_t* t, const char* fmt, char* err, size_t errn){
+    memset(t, 0, sizeof(*t));
+    size_t n = strlen(fmt);
+    if(n >= sizeof(t->src)){
+        snprintf(err, errn, "longer than %d bytes", UF_TPL_MAX - 1);
+        return -1;
+    }
+    memcpy(t->src, fmt, n + 1);
+
+    char* s = t->src;
+    size_t lit = 0;   // start of the pending literal span
+    for(size_t i=0;i<n;){
+        if((s[i] == '{' && s[i+1] == '{') || (s[i] == '}' && s[i+1] == '}')){
+            // keep one brace: end the span after it and skip the other
+            if(tpl_text(t, lit, i + 1 - lit) != 0) goto full;
+            i += 2;
+            lit = i;
+            continue;
+        }
+        if(s[i] != '{'){ i++; continue; }
+
+        char* close = strchr(s + i + 1, '}');
+        if(!close){
+            snprintf(err, errn, "unterminated '{' at offset %zu", i);
+            return -1;
+        }
+        if(tpl_text(t, lit, i - lit) != 0) goto full;
+        *close = 0;
+        if(tpl_ref(t, s + i + 1, err, errn) != 0) return -1;
+        i = (size_t)(close - s) + 1;
+        lit = i;
+    }
+    if(tpl_text(t, lit, n - lit) != 0) goto full;
+    return 0;
+full:
+    snprintf(err, errn, "more than %d parts", UF_TPL_OPS);
+    return -1;
+}
+
+static void human_bytes(long long bytes, int prec, char* out, size_t n){
+    static const char* sfx[] = {"B","KB","MB","GB","TB","PB"};
+    int i = 0; double v = (double)bytes;
+    while(v >= 1024.0 && i < 5){ v /= 1024.0; i++; }
+    snprintf(out, n, "%.*f %s", prec, v, sfx[i]);
+}
+
+// A field in its display form; precision picks the decimals for numbers.
+static void format_field(const uf_fact_t* fact, const uf_field_t* fld, int prec, char* out, size_t n){
+    switch(fld->type){
+    case UF_FACT_STR:     snprintf(out, n, "%s", uf_fact_field_str(fact, fld)); break;
+    case UF_FACT_INT:     snprintf(out, n, "%lld", fld->v.i); break;
+    case UF_FACT_BYTES:   human_bytes(fld->v.i, prec < 0 ? 1 : prec, out, n); break;
+    case UF_FACT_SECONDS:
+        snprintf(out, n, "%lldd %02lld:%02lld", fld->v.i / 86400, (fld->v.i % 86400) / 3600, (fld->v.i % 3600) / 60);
+        break;
+    case UF_FACT_MHZ:     snprintf(out, n, "%.*f GHz", prec < 0 ? 2 : prec, fld->v.d / 1000.0); break;
+    case UF_FACT_CELSIUS: snprintf(out, n, "%.*f°C", prec < 0 ? 1 : prec, fld->v.d); break;
+    case UF_FACT_PERCENT: snprintf(out, n, "%.*f%%", prec < 0 ? 0 : prec, fld->v.d); break;
+    default:              out[0] = 0;
+    }
+}
+
+// Cut to at most `max` bytes without splitting a UTF-8 sequence.
+static size_t utf8_cut(const char* s, size_t len, size_t max){
+    if(len <= max) return len;
+    while(max > 0 && ((unsigned char)s[max] & 0xC0) == 0x80) max--;
+    return max;
+}
+
+void uf_template_render(const uf_template_t* t, uf_registry_t* reg, int color, uf_frame_t* f){
+    for(int i=0;i<t->count;i++){
+        const uf_tpl_op_t* o = &t->op[i];
+        switch(o->op){
+        case TPL_TEXT:
+            uf_frame_put(f, t->src + o->off, o->len);
+            break;
+        case TPL_COLOR:
+            if(color) uf_frame_puts(f, palette[o->color].ansi);
+            break;
+        case TPL_VALUE:
+        case TPL_FIELD: {
+            char buf[UF_VALUE_MAX];
+            const char* text = buf;
+            int cut = o->precision >= 0;   // for strings precision is a length limit
+            buf[0] = 0;
+            if(o->op == TPL_VALUE){
+                text = uf_registry_value(reg, o->module);
+            }else{
+                const uf_fact_t* fact = uf_registry_fact(reg, o->module);
+                const uf_field_t* fld = uf_fact_get(fact, t->src + o->off);
+                if(fld) format_field(fact, fld, o->precision, buf, sizeof(buf));
+                cut = cut && fld && fld->type == UF_FACT_STR;
+            }
+            size_t len = strlen(text);
+            if(cut) len = utf8_cut(text, len, (size_t)o->precision);
+            int pad = o->width - uf_text_width(text, len);
+            if(!o->left && pad > 0) uf_frame_pad(f, pad);
+            uf_frame_put(f, text, len);
+            if(o->left && pad > 0) uf_frame_pad(f, pad);
+            break;
+        }
+        }
+    }
+    uf_frame_put(f, "\n", 1);
+}
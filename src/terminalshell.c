@@ -8,6 +8,8 @@
 
 #include "common.h"
 #include "terminalshell.h"
+#include "cache.h"
+#include "elfscan.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -29,34 +31,13 @@
 #define BUFFER_SIZE 1024
 #define VERSION_SIZE 256
 
-static bool read_file_data(const char* path, char* buffer, size_t size)
-{
-    FILE* file = fopen(path, "r");
-    if (!file) return false;
-    
-    size_t bytes_read = fread(buffer, 1, size - 1, file);
-    fclose(file);
-    
-    if (bytes_read > 0) {
-        buffer[bytes_read] = '\0';
-        return true;
-    }
-    return false;
-}
-
 static bool get_command_output(const char* cmd, char* buffer, size_t size)
 {
-    FILE* pipe = popen(cmd, "r");
-    if (!pipe) return false;
+    if (uf_spawn_read(cmd, buffer, size) <= 0) return false;
     
-    if (fgets(buffer, size, pipe)) {
-        pclose(pipe);
-        char* newline = strchr(buffer, '\n');
-        if (newline) *newline = '\0';
-        return true;
-    }
-    pclose(pipe);
-    return false;
+    char* newline = strchr(buffer, '\n');
+    if (newline) *newline = '\0';
+    return true;
 }
 
 static const char* get_basename_path(const char* path)
@@ -65,11 +46,6 @@ static const char* get_basename_path(const char* path)
     return last_slash ? last_slash + 1 : path;
 }
 
-static bool str_starts_with(const char* str, const char* prefix)
-{
-    return strncmp(str, prefix, strlen(prefix)) == 0;
-}
-
 static bool str_equals_ignore_case(const char* a, const char* b)
 {
     while (*a && *b) {
@@ -79,76 +55,11 @@ static bool str_equals_ignore_case(const char* a, const char* b)
     return *a == *b;
 }
 
-static bool extract_bash_version(const char* line, void* userdata)
-{
-    if (!str_starts_with(line, "@(#)Bash version ")) return true;
-    const char* start = line + strlen("@(#)Bash version ");
-    const char* end = strchr(start, '(');
-    if (!end) return true;
-    
-    size_t len = end - start;
-    if (len < VERSION_SIZE - 1) {
-        strncpy((char*)userdata, start, len);
-        ((char*)userdata)[len] = '\0';
-        return false;
-    }
-    return true;
-}
-
-static bool extract_zsh_version(const char* line, void* userdata)
-{
-    if (!str_starts_with(line, "zsh-")) return true;
-    const char* start = line + strlen("zsh-");
-    const char* end = strchr(start, '-');
-    if (!end) return true;
-    
-    size_t len = end - start;
-    if (len < VERSION_SIZE - 1) {
-        strncpy((char*)userdata, start, len);
-        ((char*)userdata)[len] = '\0';
-        return false;
-    }
-    return true;
-}
-
-static bool binary_extract_strings(const char* path, bool (*callback)(const char*, void*), void* userdata)
-{
-    FILE* file = fopen(path, "rb");
-    if (!file) return false;
-    
-    char buffer[4096];
-    size_t bytes_read;
-    char current_string[256] = {0};
-    int str_len = 0;
-    
-    while ((bytes_read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
-        for (size_t i = 0; i < bytes_read; i++) {
-            if (isprint(buffer[i])) {
-                if (str_len < sizeof(current_string) - 1) {
-                    current_string[str_len++] = buffer[i];
-                }
-            } else {
-                if (str_len > 8) {
-                    current_string[str_len] = '\0';
-                    if (!callback(current_string, userdata)) {
-                        fclose(file);
-                        return true;
-                    }
-                }
-                str_len = 0;
-            }
-        }
-    }
-    
-    fclose(file);
-    return false;
-}
-
 static bool get_shell_version_bash(const char* exe, const char* exe_path, char* version, size_t version_size)
 {
     const char* path = (exe_path && *exe_path) ? exe_path : exe;
     
-    if (binary_extract_strings(path, extract_bash_version, version)) {
+    if (uf_elf_version(path, "@(#)Bash version ", version, version_size)) {
         return true;
     }
     
@@ -179,7 +90,7 @@ static bool get_shell_version_zsh(const char* exe, const char* exe_path, char* v
 {
     const char* path = (exe_path && *exe_path) ? exe_path : exe;
     
-    if (binary_extract_strings(path, extract_zsh_version, version)) {
+    if (uf_elf_version(path, "zsh-", version, version_size)) {
         return true;
     }
     
@@ -206,6 +117,30 @@ static bool get_shell_version_zsh(const char* exe, const char* exe_path, char* v
 
 static bool get_shell_version_fish(const char* exe, char* version, size_t version_size)
 {
+    // fish installs a pkg-config file; its binary carries no anchored version
+    const char* pc_paths[] = {
+        "/usr/share/pkgconfig/fish.pc",
+        "/usr/local/share/pkgconfig/fish.pc",
+#ifdef _PATH_LOCALBASE
+        _PATH_LOCALBASE "/share/pkgconfig/fish.pc",
+#endif
+        NULL
+    };
+    char buffer[BUFFER_SIZE];
+    for (int i = 0; pc_paths[i]; i++) {
+        if (uf_read_file(pc_paths[i], buffer, sizeof(buffer)) <= 0) continue;
+        const char* line = strstr(buffer, "\nVersion:");
+        if (!line) continue;
+        line += strlen("\nVersion:");
+        line += strspn(line, " \t");
+        size_t len = strcspn(line, " \t\r\n");
+        if (len > 0 && len < version_size) {
+            memcpy(version, line, len);
+            version[len] = '\0';
+            return true;
+        }
+    }
+    
     char cmd[512];
     snprintf(cmd, sizeof(cmd), "%s --version 2>/dev/null", exe);
     char output[BUFFER_SIZE];
@@ -227,7 +162,7 @@ static bool get_shell_version_fish(const char* exe, char* version, size_t versio
     return false;
 }
 
-static bool get_shell_version_nu(const char* exe, char* version, size_t version_size)
+static bool get_shell_version_nu(const char* exe, const char* exe_path, char* version, size_t version_size)
 {
     const char* nu_version = getenv("NU_VERSION");
     if (nu_version) {
@@ -236,6 +171,12 @@ static bool get_shell_version_nu(const char* exe, char* version, size_t version_
         return true;
     }
     
+    // build metadata that shadow-rs embeds for `version`
+    const char* path = (exe_path && *exe_path) ? exe_path : exe;
+    if (uf_elf_version(path, "pkg_version:", version, version_size)) {
+        return true;
+    }
+    
     char cmd[512];
     snprintf(cmd, sizeof(cmd), "%s --version 2>/dev/null", exe);
     return get_command_output(cmd, version, version_size);
@@ -257,7 +198,7 @@ void shell_string(char* out, size_t n)
         } else if (str_equals_ignore_case(shell_name, "fish")) {
             has_version = get_shell_version_fish(shell_name, version, sizeof(version));
         } else if (str_equals_ignore_case(shell_name, "nu")) {
-            has_version = get_shell_version_nu(shell_name, version, sizeof(version));
+            has_version = get_shell_version_nu(shell_name, shell, version, sizeof(version));
         }
         
         if (has_version && version[0]) {
@@ -269,7 +210,7 @@ void shell_string(char* out, size_t n)
     }
     
     char comm[128] = {0};
-    if (read_file_data("/proc/self/comm", comm, sizeof(comm))) {
+    if (uf_read_file("/proc/self/comm", comm, sizeof(comm)) > 0) {
         char* newline = strchr(comm, '\n');
         if (newline) *newline = '\0';
         snprintf(out, n, "%s", comm);
@@ -305,7 +246,7 @@ static bool get_terminal_version_kitty(const char* exe, char* version, size_t ve
     };
     
     for (int i = 0; kitty_paths[i]; i++) {
-        if (read_file_data(kitty_paths[i], buffer, sizeof(buffer))) {
+        if (uf_read_file(kitty_paths[i], buffer, sizeof(buffer)) > 0) {
             const char* version_line = strstr(buffer, "version: Version = Version(");
             if (version_line) {
                 version_line += strlen("version: Version = Version(");
@@ -453,7 +394,7 @@ static bool get_terminal_version_alacritty(const char* exe, char* version, size_
 static bool detect_terminal_by_process(char* out, size_t n)
 {
     char comm[128] = {0};
-    if (!read_file_data("/proc/self/comm", comm, sizeof(comm))) {
+    if (uf_read_file("/proc/self/comm", comm, sizeof(comm)) <= 0) {
         return false;
     }
     
@@ -538,7 +479,7 @@ void terminal_string(char* out, size_t n)
         return;
     }
     
-    if (access("/data/data/com.termux", F_OK) == 0) {
+    if (uf_access("/data/data/com.termux", F_OK) == 0) {
         snprintf(out, n, "Termux");
         return;
     }
@@ -583,3 +524,31 @@ void terminal_string(char* out, size_t n)
         snprintf(out, n, "unknown");
     }
 }
+
+void shell_cache_stamp(char* out, size_t n)
+{
+    if (!out || n == 0) return;
+    out[0] = '\0';
+    const char* shell = getenv("SHELL");
+    uf_cache_stamp_file(shell && *shell ? shell : "", out, n);
+}
+
+void terminal_cache_stamp(char* out, size_t n)
+{
+    if (!out || n == 0) return;
+    
+    // terminal_string() is driven by these variables, so they are the key
+    const char* vars[] = {
+        "TERM_PROGRAM", "TERM_PROGRAM_VERSION",
+        "LC_TERMINAL", "LC_TERMINAL_VERSION",
+        "TERM", "COLORTERM", "TERMUX_VERSION",
+        NULL
+    };
+    
+    size_t len = 0;
+    out[0] = '\0';
+    for (int i = 0; vars[i] && len < n; i++) {
+        const char* value = getenv(vars[i]);
+        len += snprintf(out + len, n - len, "%s;", value ? value : "");
+    }
+}
@@ -0,0 +1,137 @@
+// src/trace.c — span recorder behind --trace
+#include "common.h"
+#include "trace.h"
+
+#ifdef UF_TRACE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+#define TRACE_DEPTH 16
+#define TRACE_DETAIL 160
+
+typedef struct {
+    const char* name;
+    char detail[TRACE_DETAIL];
+    long long ts_us;
+    long long dur_us;
+    int tid;
+} trace_event_t;
+
+typedef struct {
+    const char* name;
+    char detail[TRACE_DETAIL];
+    long long ts_us;
+} trace_open_t;
+
+int UF_TRACE_ON = 0;
+
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static trace_event_t* trace_events;
+static size_t trace_count, trace_cap;
+static char trace_path[4096];
+static long long trace_origin_us;
+
+static _Thread_local trace_open_t tl_stack[TRACE_DEPTH];
+static _Thread_local int tl_depth;
+
+static long long now_us(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+int uf_trace_open(const char* path){
+    if(!path || !*path) return -1;
+    snprintf(trace_path, sizeof(trace_path), "%s", path);
+    trace_origin_us = now_us();
+    UF_TRACE_ON = 1;
+    return 0;
+}
+
+void uf_trace_begin(const char* name, const char* detail){
+    // spans deeper than the stack are dropped, their ends still balance
+    if(tl_depth < TRACE_DEPTH){
+        trace_open_t* o = &tl_stack[tl_depth];
+        o->name = name;
+        snprintf(o->detail, sizeof(o->detail), "%s", detail ? detail : "");
+        o->ts_us = now_us();
+    }
+    tl_depth++;
+}
+
+void uf_trace_end(void){
+    if(tl_depth == 0) return;
+    tl_depth--;
+    if(tl_depth >= TRACE_DEPTH) return;
+
+    trace_open_t* o = &tl_stack[tl_depth];
+    long long end = now_us();
+
+    pthread_mutex_lock(&trace_lock);
+    if(trace_count == trace_cap){
+        size_t cap = trace_cap ? trace_cap * 2 : 128;
+        trace_event_t* grown = realloc(trace_events, cap * sizeof(*grown));
+        if(!grown){ pthread_mutex_unlock(&trace_lock); return; }
+        trace_events = grown;
+        trace_cap = cap;
+    }
+    trace_event_t* e = &trace_events[trace_count++];
+    e->name = o->name;
+    memcpy(e->detail, o->detail, sizeof(e->detail));
+    e->ts_us = o->ts_us - trace_origin_us;
+    e->dur_us = end - o->ts_us;
+    e->tid = (int)gettid();
+    pthread_mutex_unlock(&trace_lock);
+}
+
+static void put_json_string(FILE* f, const char* s){
+    fputc('"', f);
+    for(; *s; s++){
+        unsigned char c = (unsigned char)*s;
+        if(c == '"' || c == '\\') fprintf(f, "\\%c", c);
+        else if(c < 0x20) fprintf(f, "\\u%04x", c);
+        else fputc(c, f);
+    }
+    fputc('"', f);
+}
+
+int uf_trace_finish(void){
+    if(!UF_TRACE_ON) return 0;
+    UF_TRACE_ON = 0;
+
+    FILE* f = fopen(trace_path, "w");
+    if(!f){
+        fprintf(stderr, "ultrafetch: cannot write %s: %s\n", trace_path, strerror(errno));
+        return -1;
+    }
+    int pid = (int)getpid();
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"xfetch\"}}", pid);
+
+    pthread_mutex_lock(&trace_lock);
+    for(size_t i=0;i<trace_count;i++){
+        trace_event_t* e = &trace_events[i];
+        fprintf(f, ",\n{\"name\":");
+        put_json_string(f, e->name);
+        fprintf(f, ",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":%d,\"tid\":%d",
+                e->ts_us, e->dur_us, pid, e->tid);
+        if(e->detail[0]){
+            fprintf(f, ",\"args\":{\"detail\":");
+            put_json_string(f, e->detail);
+            fputc('}', f);
+        }
+        fputc('}', f);
+    }
+    pthread_mutex_unlock(&trace_lock);
+
+    fprintf(f, "\n]}\n");
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+#endif
@@ -4,15 +4,15 @@
 #include <sys/sysinfo.h>
 #include <stdio.h>
 
-void uptime_string(char* out, size_t n){
+void uptime_fact(uf_fact_t* f){
     struct sysinfo si;
-    if(sysinfo(&si)==0){
-        long long up = si.uptime;
-        long long d = up/86400;
-        long long h = (up%86400)/3600;
-        long long m = (up%3600)/60;
-        snprintf(out,n,"%lldd %02lld:%02lld", d, h, m);
-    }else{
-        snprintf(out,n,"0d 00:00");
-    }
+    if(uf_sysinfo(&si)==0) uf_fact_int(f, "seconds", UF_FACT_SECONDS, si.uptime);
+}
+
+void uptime_text(const uf_fact_t* f, char* out, size_t n){
+    long long up = uf_fact_get_int(f, "seconds", 0);
+    long long d = up/86400;
+    long long h = (up%86400)/3600;
+    long long m = (up%3600)/60;
+    snprintf(out,n,"%lldd %02lld:%02lld", d, h, m);
 }
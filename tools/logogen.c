@@ -0,0 +1,85 @@
+// tools/logogen.c — embed logos/*.txt into one C translation unit
+//
+// Usage: logogen <output.c> <logo.txt>...
+//
+// Each logo is keyed by its file name, lower-cased and without ".txt"
+// (logos/ubuntu.txt -> "ubuntu"), which is matched against the os-release
+// ID and ID_LIKE values. Entries are sorted by key for binary search.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+typedef struct {
+    char key[64];
+    const char* path;
+} logo_t;
+
+static int logo_cmp(const void* a, const void* b){
+    return strcmp(((const logo_t*)a)->key, ((const logo_t*)b)->key);
+}
+
+static int emit(FILE* out, const char* path){
+    FILE* in = fopen(path, "rb");
+    if(!in){ perror(path); return 0; }
+    int c;
+    fputs("        \"", out);
+    while((c = fgetc(in)) != EOF){
+        if(c == '\n'){
+            fputs("\\n\"\n        \"", out);
+            continue;
+        }
+        // '?' too, so "??/" in a logo is never read as a trigraph under -std=c11
+        if(c == '\\' || c == '"' || c == '?') fprintf(out, "\\%c", c);
+        else if(c == '\t') fputs("\\t", out);
+        else if(c < 0x20 || c >= 0x7f) fprintf(out, "\\%03o", c);
+        else fputc(c, out);
+    }
+    fputs("\"", out);
+    fclose(in);
+    return 1;
+}
+
+int main(int argc, char** argv){
+    if(argc < 2){
+        fprintf(stderr, "usage: logogen <output.c> <logo.txt>...\n");
+        return 2;
+    }
+    size_t count = (size_t)(argc - 2);
+    logo_t* logos = calloc(count ? count : 1, sizeof(*logos));
+    if(!logos){ fprintf(stderr, "logogen: out of memory\n"); return 1; }
+
+    for(size_t i = 0; i < count; i++){
+        const char* path = argv[i + 2];
+        const char* base = strrchr(path, '/');
+        base = base ? base + 1 : path;
+        size_t len = strcspn(base, ".");
+        if(len == 0 || len >= sizeof(logos[i].key)){
+            fprintf(stderr, "%s: bad logo name\n", path);
+            return 1;
+        }
+        for(size_t k = 0; k < len; k++) logos[i].key[k] = (char)tolower((unsigned char)base[k]);
+        logos[i].path = path;
+    }
+    qsort(logos, count, sizeof(*logos), logo_cmp);
+    for(size_t i = 1; i < count; i++){
+        if(strcmp(logos[i - 1].key, logos[i].key) == 0){
+            fprintf(stderr, "%s: duplicate logo \"%s\"\n", logos[i].path, logos[i].key);
+            return 1;
+        }
+    }
+
+    FILE* out = fopen(argv[1], "w");
+    if(!out){ perror(argv[1]); return 1; }
+    fputs("// Generated by tools/logogen from logos/*.txt; edit those files instead.\n", out);
+    fputs("#include \"logo.h\"\n\n", out);
+    fputs("const uf_logo_t uf_logos[] = {\n", out);
+    for(size_t i = 0; i < count; i++){
+        fprintf(out, "    { \"%s\",\n", logos[i].key);
+        if(!emit(out, logos[i].path)){ fclose(out); remove(argv[1]); return 1; }
+        fputs(" },\n", out);
+    }
+    fprintf(out, "};\nconst size_t uf_logos_count = %zu;\n", count);
+    if(fclose(out) != 0){ perror(argv[1]); return 1; }
+    return 0;
+}
@@ -0,0 +1,146 @@
+// tools/mapgen.c — compile a mapping/*.txt data file into a sorted C table
+//
+// Usage: mapgen <input.txt> <output.c>
+//
+// The first directive line names the table and the key type:
+//     @table uf_map_soc str      keys compared with strcmp
+//     @table uf_map_macos num    decimal or 0x-prefixed integer keys
+//     @table uf_map_arm midr     "implementer:part", e.g. 0x41:0xd05
+// Every other non-empty line that does not start with '#' is
+// "<key> <value...>". Rows are sorted so the runtime can binary search them;
+// a repeated key is an error. Runs on the build host, so it only uses ISO C.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+enum { KEY_STR, KEY_NUM, KEY_MIDR };
+
+typedef struct {
+    char* key;
+    unsigned long num;
+    char* value;
+    int line;
+} row_t;
+
+static const char* in_path;
+static int key_type = -1;
+
+static void fail(int line, const char* msg){
+    fprintf(stderr, "%s:%d: %s\n", in_path, line, msg);
+    exit(1);
+}
+
+static char* dup_range(const char* s, size_t n){
+    char* d = malloc(n + 1);
+    if(!d){ fprintf(stderr, "mapgen: out of memory\n"); exit(1); }
+    memcpy(d, s, n);
+    d[n] = 0;
+    return d;
+}
+
+static int parse_num(const char* s, unsigned long* out){
+    char* end;
+    *out = strtoul(s, &end, 0);
+    return end != s && *end == 0;
+}
+
+static int row_cmp(const void* a, const void* b){
+    const row_t* x = a;
+    const row_t* y = b;
+    if(key_type == KEY_STR) return strcmp(x->key, y->key);
+    return x->num < y->num ? -1 : x->num > y->num;
+}
+
+static void put_string(FILE* f, const char* s){
+    fputc('"', f);
+    for(; *s; s++){
+        if(*s == '"' || *s == '\\') fputc('\\', f);
+        fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+int main(int argc, char** argv){
+    if(argc != 3){
+        fprintf(stderr, "usage: mapgen <input.txt> <output.c>\n");
+        return 2;
+    }
+    in_path = argv[1];
+    FILE* in = fopen(in_path, "r");
+    if(!in){ perror(in_path); return 1; }
+
+    char table[64] = "";
+    row_t* rows = NULL;
+    size_t count = 0, cap = 0;
+    char buf[1024];
+    int line = 0;
+    while(fgets(buf, sizeof(buf), in)){
+        line++;
+        size_t len = strcspn(buf, "\r\n");
+        buf[len] = 0;
+        while(len > 0 && isspace((unsigned char)buf[len - 1])) buf[--len] = 0;
+        char* p = buf;
+        while(isspace((unsigned char)*p)) p++;
+        if(!*p || *p == '#') continue;
+
+        if(*p == '@'){
+            char type[16];
+            if(sscanf(p, "@table %63s %15s", table, type) != 2) fail(line, "expected \"@table <name> <str|num|midr>\"");
+            if(!strcmp(type, "str")) key_type = KEY_STR;
+            else if(!strcmp(type, "num")) key_type = KEY_NUM;
+            else if(!strcmp(type, "midr")) key_type = KEY_MIDR;
+            else fail(line, "unknown key type");
+            continue;
+        }
+        if(key_type < 0) fail(line, "row before the @table directive");
+
+        size_t klen = strcspn(p, " \t");
+        char* value = p + klen;
+        while(isspace((unsigned char)*value)) value++;
+        if(!*value) fail(line, "row has no value");
+
+        row_t r = { dup_range(p, klen), 0, dup_range(value, strlen(value)), line };
+        if(key_type == KEY_NUM && !parse_num(r.key, &r.num)) fail(line, "bad numeric key");
+        if(key_type == KEY_MIDR){
+            char* colon = strchr(r.key, ':');
+            unsigned long impl, part;
+            if(!colon) fail(line, "midr key must be implementer:part");
+            *colon = 0;
+            if(!parse_num(r.key, &impl) || !parse_num(colon + 1, &part) || impl > 0xff || part > 0xfff)
+                fail(line, "bad midr key");
+            *colon = ':';
+            r.num = impl << 12 | part;
+        }
+
+        if(count == cap){
+            cap = cap ? cap * 2 : 64;
+            rows = realloc(rows, cap * sizeof(*rows));
+            if(!rows){ fprintf(stderr, "mapgen: out of memory\n"); return 1; }
+        }
+        rows[count++] = r;
+    }
+    fclose(in);
+    if(key_type < 0 || count == 0) fail(line, "no @table directive or no rows");
+
+    qsort(rows, count, sizeof(*rows), row_cmp);
+    for(size_t i = 1; i < count; i++)
+        if(row_cmp(&rows[i - 1], &rows[i]) == 0) fail(rows[i].line, "duplicate key");
+
+    FILE* out = fopen(argv[2], "w");
+    if(!out){ perror(argv[2]); return 1; }
+    fprintf(out, "// Generated by tools/mapgen from %s; edit that file instead.\n", in_path);
+    fprintf(out, "#include \"mapping.h\"\n\n");
+    fprintf(out, "const %s %s[] = {\n", key_type == KEY_STR ? "uf_map_str_t" : "uf_map_num_t", table);
+    for(size_t i = 0; i < count; i++){
+        fputs("    { ", out);
+        if(key_type == KEY_STR) put_string(out, rows[i].key);
+        else fprintf(out, "0x%05lx", rows[i].num);
+        fputs(", ", out);
+        put_string(out, rows[i].value);
+        fputs(" },\n", out);
+    }
+    fprintf(out, "};\nconst size_t %s_count = %zu;\n", table, count);
+    if(fclose(out) != 0){ perror(argv[2]); return 1; }
+    return 0;
+}